@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+
+
+"""
+Converts a CSV demand file for the TraceTrafficManager into the binary format,
+which the simulation memory maps instead of parsing text.
+
+CSV lines have the fields
+    time,vType,route,lane,position,speed,platoonId,platoonPosition,controller
+and lines starting with # are ignored. See src/plexe/traffic/DemandReader.h.
+
+Example:
+    plexe-demand.py demand.csv demand.bin
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"PLXDEMND"
+VERSION = 1
+# time, position, speed, platoonId, vType, route, lane, platoonPosition, controller
+RECORD = struct.Struct("=dffiHHhhb3x")
+# values of enum ACTIVE_CONTROLLER in CC_Const.h
+CONTROLLERS = {"": -1, "DRIVER": 0, "ACC": 1, "CACC": 2, "PLOEG": 4, "CONSENSUS": 5, "FLATBED": 6}
+U32 = struct.Struct("=I")
+
+
+def index_of(names, indexes, name):
+    if name not in indexes:
+        indexes[name] = len(names)
+        names.append(name)
+    return indexes[name]
+
+
+def write_names(out, names):
+    out.write(U32.pack(len(names)))
+    for name in names:
+        encoded = name.encode("utf-8")
+        out.write(U32.pack(len(encoded)))
+        out.write(encoded)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a CSV demand file into a binary one")
+    parser.add_argument("csv", help="CSV demand file to read")
+    parser.add_argument("binary", help="binary demand file to write")
+    args = parser.parse_args()
+
+    types, type_indexes = [], {}
+    routes, route_indexes = [], {}
+    records = []
+    with open(args.csv) as csv:
+        for number, line in enumerate(csv, 1):
+            line = line.rstrip("\r\n")
+            if not line or line.startswith("#"):
+                continue
+            fields = line.split(",")
+            if len(fields) == 8:
+                fields.append("")
+            if len(fields) != 9:
+                print("%s:%d: expected 9 fields, found %d" % (args.csv, number, len(fields)))
+                return 1
+            if fields[8] not in CONTROLLERS:
+                print("%s:%d: invalid controller %s" % (args.csv, number, fields[8]))
+                return 1
+            records.append(RECORD.pack(float(fields[0]), float(fields[4]), float(fields[5]), int(fields[6]),
+                                       index_of(types, type_indexes, fields[1]), index_of(routes, route_indexes, fields[2]),
+                                       int(fields[3]), int(fields[7]), CONTROLLERS[fields[8]]))
+
+    with open(args.binary, "wb") as out:
+        out.write(MAGIC)
+        out.write(U32.pack(VERSION))
+        write_names(out, types)
+        write_names(out, routes)
+        for record in records:
+            out.write(record)
+    print("Converted %d events" % len(records))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
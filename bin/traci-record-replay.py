@@ -0,0 +1,192 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+
+"""
+Records the TraCI traffic of a simulation and replays it without SUMO.
+
+In record mode, the script sits between the simulation and the TraCI server
+(sumo-launchd.py or SUMO itself), forwards every message, and stores each
+request/response pair into a compressed binary log. In replay mode, the
+script acts as the TraCI server: it answers every request with the recorded
+response, so the simulation runs without SUMO. Every request is compared
+with the recorded one. When the sequence of requests changes (e.g., because
+a parameter change affected mobility), the divergence is reported and the
+connection is closed, making the simulation stop with a TraCI error.
+
+The log captures all TraCI traffic, i.e., both the one of the Veins
+scenario manager and the one of the Plexe command interface.
+
+Example, recording a run while sumo-launchd.py listens on port 9999:
+    traci-record-replay.py record --port 9998 --server-port 9999 run.trace
+    ./run -u Cmdenv -c Platooning -r 0 --*.manager.port=9998
+
+Replaying the same run without SUMO:
+    traci-record-replay.py replay --port 9998 run.trace
+    ./run -u Cmdenv -c Platooning -r 0 --*.manager.port=9998
+"""
+
+import argparse
+import gzip
+import socket
+import struct
+import sys
+
+MAGIC = b"PLEXETRC"
+VERSION = 1
+# TraCI messages start with their total length as a 4 bytes big endian integer
+LENGTH = struct.Struct("!I")
+
+
+def receive_exactly(sock, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            return None
+        data.extend(chunk)
+    return bytes(data)
+
+
+def receive_message(sock):
+    header = receive_exactly(sock, LENGTH.size)
+    if header is None:
+        return None
+    length = LENGTH.unpack(header)[0]
+    body = receive_exactly(sock, length - LENGTH.size)
+    if body is None:
+        return None
+    return header + body
+
+
+def write_blob(log, blob):
+    log.write(LENGTH.pack(len(blob)))
+    log.write(blob)
+
+
+def read_blob(log):
+    header = log.read(LENGTH.size)
+    if len(header) < LENGTH.size:
+        return None
+    return log.read(LENGTH.unpack(header)[0])
+
+
+def accept_client(port):
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("localhost", port))
+    listener.listen(1)
+    print("Waiting for the simulation on port %d" % port)
+    client, _ = listener.accept()
+    listener.close()
+    client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return client
+
+
+def record(args):
+    server = socket.create_connection((args.server_host, args.server_port))
+    server.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    client = accept_client(args.port)
+    pairs = 0
+    with gzip.open(args.log, "wb") as log:
+        log.write(MAGIC)
+        log.write(LENGTH.pack(VERSION))
+        while True:
+            request = receive_message(client)
+            if request is None:
+                break
+            server.sendall(request)
+            response = receive_message(server)
+            if response is None:
+                break
+            client.sendall(response)
+            write_blob(log, request)
+            write_blob(log, response)
+            pairs += 1
+    client.close()
+    server.close()
+    print("Recorded %d request/response pairs into %s" % (pairs, args.log))
+
+
+def report_divergence(index, expected, actual):
+    offset = 0
+    while offset < min(len(expected), len(actual)) and expected[offset] == actual[offset]:
+        offset += 1
+    print("Divergence at request %d, byte %d" % (index, offset))
+    print("  recorded: %s" % expected[offset:offset + 32].hex())
+    print("  received: %s" % actual[offset:offset + 32].hex())
+
+
+def replay(args):
+    with gzip.open(args.log, "rb") as log:
+        if log.read(len(MAGIC)) != MAGIC:
+            print("%s is not a TraCI trace" % args.log)
+            return 1
+        version = LENGTH.unpack(log.read(LENGTH.size))[0]
+        if version != VERSION:
+            print("Unsupported trace version %d" % version)
+            return 1
+        client = accept_client(args.port)
+        index = 0
+        while True:
+            request = receive_message(client)
+            if request is None:
+                break
+            expected = read_blob(log)
+            if expected is None:
+                print("Trace ended before request %d" % index)
+                client.close()
+                return 1
+            response = read_blob(log)
+            if request != expected:
+                report_divergence(index, expected, request)
+                client.close()
+                return 1
+            client.sendall(response)
+            index += 1
+        client.close()
+    print("Replayed %d request/response pairs" % index)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Record or replay the TraCI traffic of a simulation")
+    subparsers = parser.add_subparsers(dest="mode")
+    subparsers.required = True
+
+    record_parser = subparsers.add_parser("record", help="forward traffic to a TraCI server and record it")
+    record_parser.add_argument("--port", type=int, default=9998, help="port the simulation connects to [default: 9998]")
+    record_parser.add_argument("--server-host", default="localhost", help="host of the TraCI server [default: localhost]")
+    record_parser.add_argument("--server-port", type=int, default=9999, help="port of the TraCI server [default: 9999]")
+    record_parser.add_argument("log", help="trace file to write")
+
+    replay_parser = subparsers.add_parser("replay", help="answer the simulation from a recorded trace")
+    replay_parser.add_argument("--port", type=int, default=9998, help="port the simulation connects to [default: 9998]")
+    replay_parser.add_argument("log", help="trace file to read")
+
+    args = parser.parse_args()
+    if args.mode == "record":
+        record(args)
+        return 0
+    return replay(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -21,16 +21,55 @@
 #include "PlexeManager.h"
 
 #include "plexe/mobility/CommandInterface.h"
+#include "plexe/apps/GeneralPlatooningApp.h"
+#include "plexe/protocols/BaseProtocol.h"
+#include "plexe/utilities/BasePositionHelper.h"
+#include "plexe/utilities/DynamicPositionManager.h"
+#include "plexe/utilities/MessagePool.h"
+
+#include "veins/modules/mobility/traci/TraCIMobility.h"
+
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <climits>
+#include <unistd.h>
 
 namespace plexe {
 
 Define_Module(PlexeManager);
 
+const simsignal_t PlexeManager::timestepBeginSignal = registerSignal("org_car2x_plexe_PlexeManager_timestepBegin");
+const simsignal_t PlexeManager::fastForwardEndSignal = registerSignal("org_car2x_plexe_PlexeManager_fastForwardEnd");
+const simsignal_t PlexeManager::collisionSignal = registerSignal("org_car2x_plexe_PlexeManager_collision");
+
 void PlexeManager::initialize(int stage)
 {
     const auto scenarioManager = veins::TraCIScenarioManagerAccess().get();
     ASSERT(scenarioManager);
 
+    wallClockStart = std::chrono::steady_clock::now();
+    fastForwardUntil = par("fastForwardUntil");
+    fastForwarding = fastForwardUntil > 0;
+    wallClockMark = par("wallClockMark");
+    watchCollisions = par("watchCollisions").boolValue();
+
+    // messages of a previous run are gone, give their memory back
+    MessagePool::reset();
+
+    if (par("recordModuleChurn").boolValue()) subscribeModuleChurn(scenarioManager);
+
+    checkpointFile = par("checkpointFile").stdstringValue();
+    checkpointAt = par("checkpointAt");
+    restoreCheckpoint = !checkpointFile.empty() && par("restoreCheckpoint").boolValue();
+    if (!checkpointFile.empty() && !restoreCheckpoint) {
+        auto checkpoint = [this](veins::SignalPayload<simtime_t const&>) {
+            if (!checkpointSaved && simTime() >= checkpointAt) saveCheckpoint();
+        };
+        signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepEndSignal, checkpoint);
+    }
+
     if (scenarioManager->isUsable()) {
         initializeCommandInterface();
     }
@@ -45,6 +84,313 @@ void PlexeManager::initializeCommandInterface()
     const auto scenarioManager = veins::TraCIScenarioManagerAccess().get();
     ASSERT(scenarioManager);
     commandInterface.reset(new traci::CommandInterface(this, scenarioManager->getCommandInterface(), scenarioManager->getConnection()));
+    commandInterface->setBatchCommands(par("batchCommands").boolValue());
+
+    // pending commands must reach SUMO before it computes the next simulation step
+    auto flush = [this](veins::SignalPayload<simtime_t const&> payload) {
+        if (fastForwarding && simTime() >= fastForwardUntil) endFastForward();
+        if (wallClockMark >= 0 && !wallClockMarkReached && simTime() >= wallClockMark) {
+            wallClockMarkReached = true;
+            wallClockAtMark = std::chrono::steady_clock::now();
+        }
+        emit(timestepBeginSignal, payload.p);
+        commandInterface->flushCommands();
+    };
+    signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepBeginSignal, flush);
+
+    commandInterface->setUseSubscriptions(par("useSubscriptions").boolValue());
+    if (commandInterface->isUsingSubscriptions()) {
+        // subscribed data refers to the previous step once SUMO has moved on
+        auto invalidate = [this](veins::SignalPayload<simtime_t const&>) { commandInterface->invalidateSubscriptions(); };
+        signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepEndSignal, invalidate);
+    }
+
+    commandInterface->setShadowParameters(par("shadowParameters").boolValue(), par("shadowVerificationInterval").intValue());
+    commandInterface->setFastParameterEncoding(par("fastParameterEncoding").boolValue());
+    commandInterface->setInstrumentCommands(par("instrumentCommands").boolValue());
+
+    // data cached for vehicles that left the simulation is never used again.
+    // the scenario manager emits the signal before deleting the module
+    auto removed = [this](veins::SignalPayload<cObject*> payload) {
+        veins::TraCIMobility* mobility = veins::TraCIMobilityAccess().get(check_and_cast<cModule*>(payload.p));
+        if (mobility) commandInterface->forgetVehicle(mobility->getExternalId());
+    };
+    signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciModuleRemovedSignal, removed);
+
+    if (watchCollisions) {
+        // SUMO detects collisions while computing the step, so the list is complete at its end
+        auto check = [this](veins::SignalPayload<simtime_t const&>) { checkCollisions(); };
+        signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciTimestepEndSignal, check);
+    }
+
+    if (restoreCheckpoint) loadCheckpoint();
+}
+
+void PlexeManager::checkCollisions()
+{
+    const auto scenarioManager = veins::TraCIScenarioManagerAccess().get();
+    for (const auto& vehicleId : commandInterface->getCollidingVehicles()) {
+        collidingVehicles++;
+        // vehicles not managed by veins (e.g., filtered by moduleType) have nobody to notify
+        cModule* host = scenarioManager->getManagedModule(vehicleId);
+        if (!host) continue;
+        EV << "Vehicle " << vehicleId << " involved in a collision\n";
+        host->emit(collisionSignal, true);
+    }
+}
+
+void PlexeManager::endFastForward()
+{
+    if (!fastForwarding) return;
+    fastForwarding = false;
+    fastForwardEnd = std::chrono::steady_clock::now();
+    EV << "Fast-forward phase ended at " << simTime() << "\n";
+    emit(fastForwardEndSignal, simTime());
+}
+
+namespace {
+
+const char* CHECKPOINT_HEADER = "plexe-checkpoint 1";
+
+} // namespace
+
+std::string PlexeManager::getCheckpointPath(const std::string& suffix) const
+{
+    std::string path = checkpointFile + suffix;
+    if (path[0] == '/') return path;
+    // SUMO resolves relative paths against its own working directory
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) throw cRuntimeError("Cannot determine the working directory for checkpoint %s", path.c_str());
+    return std::string(cwd) + "/" + path;
+}
+
+void PlexeManager::saveCheckpoint()
+{
+    checkpointSaved = true;
+    // maneuvers cannot be resumed, as applications start from scratch
+    for (const auto& host : veins::TraCIScenarioManagerAccess().get()->getManagedHosts()) {
+        GeneralPlatooningApp* app = dynamic_cast<GeneralPlatooningApp*>(host.second->getSubmodule("appl"));
+        if (app && app->isInManeuver()) throw cRuntimeError("Cannot save checkpoint %s at %ss: %s is performing a maneuver. Choose a checkpointAt time at which no maneuver is in progress", checkpointFile.c_str(), simTime().str().c_str(), host.first.c_str());
+    }
+    commandInterface->saveState(getCheckpointPath(".sumo.xml"));
+
+    const DynamicPositionManager& positions = DynamicPositionManager::getInstance();
+    std::map<int, std::vector<int>> formations;
+    std::map<int, PlatoonInfo> information = positions.information;
+    std::map<int, VehicleInfo> vehicles = positions.vehicleInfo;
+    for (const auto& platoon : positions.platoons) {
+        for (const auto& member : platoon.second) formations[platoon.first].push_back(member.second);
+    }
+
+    // position helpers know about formation changes due to maneuvers
+    std::map<int, int> helperPlatoons;
+    std::set<int> leaderFormations;
+    std::map<int, std::string> protocols;
+    for (const auto& host : veins::TraCIScenarioManagerAccess().get()->getManagedHosts()) {
+        BasePositionHelper* helper = dynamic_cast<BasePositionHelper*>(host.second->getSubmodule("helper"));
+        if (!helper) continue;
+        if (BaseProtocol* protocol = dynamic_cast<BaseProtocol*>(host.second->getSubmodule("prot"))) {
+            std::stringstream state;
+            protocol->saveState(state);
+            protocols[helper->getId()] = state.str();
+        }
+        VehicleInfo& info = vehicles[helper->getId()];
+        info.id = helper->getId();
+        info.platoonId = helper->getPlatoonId();
+        info.position = helper->getPosition();
+        info.controller = helper->getController();
+        info.distance = helper->getDistance();
+        info.headway = helper->getHeadway();
+        helperPlatoons[info.id] = info.platoonId;
+        if (helper->isLeader()) {
+            formations[info.platoonId] = helper->getPlatoonFormation();
+            information[info.platoonId].speed = helper->getPlatoonSpeed();
+            information[info.platoonId].lane = helper->getPlatoonLane();
+            leaderFormations.insert(info.platoonId);
+        }
+    }
+    // without a leader, use the initial formation minus the vehicles that moved to another platoon
+    for (auto& formation : formations) {
+        if (leaderFormations.count(formation.first)) continue;
+        std::vector<int> members;
+        for (int id : formation.second) {
+            auto platoon = helperPlatoons.find(id);
+            if (platoon == helperPlatoons.end() || platoon->second == formation.first) members.push_back(id);
+        }
+        formation.second = members;
+    }
+
+    std::ofstream out(getCheckpointPath(".plexe"));
+    if (!out) throw cRuntimeError("Cannot write checkpoint %s", getCheckpointPath(".plexe").c_str());
+    out << std::setprecision(17);
+    out << CHECKPOINT_HEADER << "\n";
+    out << "time " << simTime() << "\n";
+    for (const auto& formation : formations) {
+        if (formation.second.empty()) continue;
+        const PlatoonInfo& info = information[formation.first];
+        out << "platoon " << formation.first << " " << info.speed << " " << info.lane << " " << formation.second.size();
+        for (int id : formation.second) out << " " << id;
+        out << "\n";
+    }
+    for (const auto& vehicle : vehicles) {
+        const VehicleInfo& info = vehicle.second;
+        out << "vehicle " << vehicle.first << " " << info.platoonId << " " << info.position << " " << info.controller << " " << info.distance << " " << info.headway << "\n";
+    }
+    for (const auto& protocol : protocols) out << "protocol " << protocol.first << " " << protocol.second << "\n";
+    EV << "Saved checkpoint " << checkpointFile << " at " << simTime() << "\n";
+}
+
+void PlexeManager::loadCheckpoint()
+{
+    std::ifstream in(getCheckpointPath(".plexe"));
+    if (!in) throw cRuntimeError("Cannot read checkpoint %s", getCheckpointPath(".plexe").c_str());
+    std::string line;
+    if (!std::getline(in, line) || line != CHECKPOINT_HEADER) throw cRuntimeError("Invalid checkpoint %s", getCheckpointPath(".plexe").c_str());
+
+    std::map<int, std::vector<int>> formations;
+    std::map<int, PlatoonInfo> information;
+    std::map<int, VehicleInfo> vehicles;
+    while (std::getline(in, line)) {
+        std::stringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        if (kind == "time") {
+            std::string time;
+            fields >> time;
+            if (SimTime::parse(time.c_str()) != simTime()) throw cRuntimeError("Checkpoint %s was taken at %ss, but the connection to SUMO was established at %ss. Set connectAt of the scenario manager to %ss", checkpointFile.c_str(), time.c_str(), simTime().str().c_str(), time.c_str());
+        }
+        else if (kind == "platoon") {
+            int platoonId, size;
+            PlatoonInfo info;
+            fields >> platoonId >> info.speed >> info.lane >> size;
+            information[platoonId] = info;
+            std::vector<int>& formation = formations[platoonId];
+            formation.resize(size);
+            for (int& id : formation) fields >> id;
+        }
+        else if (kind == "vehicle") {
+            int id, controller;
+            VehicleInfo info;
+            fields >> id >> info.platoonId >> info.position >> controller >> info.distance >> info.headway;
+            info.id = id;
+            info.controller = (enum ACTIVE_CONTROLLER) controller;
+            vehicles[id] = info;
+        }
+        else if (kind == "protocol") {
+            // parsed by the protocol once the vehicle module is built
+            int id;
+            fields >> id;
+            std::getline(fields, protocolStates[id]);
+        }
+        if (fields.fail()) throw cRuntimeError("Invalid line in checkpoint %s: %s", getCheckpointPath(".plexe").c_str(), line.c_str());
+    }
+
+    commandInterface->loadState(getCheckpointPath(".sumo.xml"));
+
+    DynamicPositionManager& positions = DynamicPositionManager::getInstance();
+    positions.clear();
+    for (const auto& vehicle : vehicles) positions.setVehicleInfo(vehicle.first, vehicle.second);
+    for (const auto& formation : formations) {
+        positions.setPlatoonInformation(formation.first, information[formation.first]);
+        for (int i = 0; i < (int) formation.second.size(); i++) {
+            VehicleInfo info = positions.getVehicleInfo(formation.second[i]);
+            info.id = formation.second[i];
+            info.platoonId = formation.first;
+            info.position = i;
+            positions.addVehicleToPlatoon(info.id, info);
+        }
+    }
+    EV << "Restored checkpoint " << checkpointFile << " at " << simTime() << "\n";
+}
+
+void PlexeManager::restoreProtocolState(int vehicleId, BaseProtocol* protocol)
+{
+    auto state = protocolStates.find(vehicleId);
+    if (state == protocolStates.end()) return;
+    std::stringstream in(state->second);
+    protocol->loadState(in);
+    protocolStates.erase(state);
+}
+
+void PlexeManager::subscribeModuleChurn(veins::TraCIScenarioManager* scenarioManager)
+{
+    moduleInitialization.setName("moduleInitialization");
+
+    // the scenario manager emits the first signal before calling initialize() and the second one after
+    auto preInit = [this](veins::SignalPayload<cObject*>) { moduleInitializationStart = std::chrono::steady_clock::now(); };
+    signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciModulePreInitSignal, preInit);
+
+    auto added = [this](veins::SignalPayload<cObject*> payload) {
+        moduleInitialization.collect(std::chrono::duration<double>(std::chrono::steady_clock::now() - moduleInitializationStart).count());
+        modulesAdded++;
+        auto idle = idleModules.find(check_and_cast<cModule*>(payload.p)->getComponentType()->getFullName());
+        if (idle != idleModules.end() && idle->second > 0) {
+            idle->second--;
+            idleModulesCount--;
+            poolHits++;
+        }
+    };
+    signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciModuleAddedSignal, added);
+
+    auto removed = [this](veins::SignalPayload<cObject*> payload) {
+        modulesRemoved++;
+        idleModules[check_and_cast<cModule*>(payload.p)->getComponentType()->getFullName()]++;
+        idleModulesCount++;
+        maxIdleModules = std::max(maxIdleModules, idleModulesCount);
+    };
+    signalManager.subscribeCallback(scenarioManager, veins::TraCIScenarioManager::traciModuleRemovedSignal, removed);
+}
+
+void PlexeManager::finish()
+{
+    // wall clock times allow to compare runs with and without fast-forward
+    // phase. they differ at each run, so they are only recorded on request
+    if (fastForwardUntil > 0 || wallClockMark >= 0) recordScalar("wallClock", std::chrono::duration<double>(std::chrono::steady_clock::now() - wallClockStart).count(), "s");
+    if (fastForwardUntil > 0) {
+        auto end = fastForwarding ? std::chrono::steady_clock::now() : fastForwardEnd;
+        recordScalar("fastForwardWallClock", std::chrono::duration<double>(end - wallClockStart).count(), "s");
+    }
+    if (wallClockMarkReached) recordScalar("wallClockAtMark", std::chrono::duration<double>(wallClockAtMark - wallClockStart).count(), "s");
+    if (watchCollisions) recordScalar("collidingVehicles", collidingVehicles);
+    if (par("recordModuleChurn").boolValue()) {
+        recordScalar("modulesAdded", modulesAdded);
+        recordScalar("modulesRemoved", modulesRemoved);
+        recordScalar("modulePoolHits", poolHits);
+        recordScalar("modulePoolHitRate", modulesAdded > 0 ? (double) poolHits / modulesAdded : 0);
+        recordScalar("maxIdleModules", maxIdleModules);
+        recordStatistic(&moduleInitialization, "s");
+    }
+    if (par("recordMessagePool").boolValue()) {
+        const MessagePool::Statistics& stats = MessagePool::getStatistics();
+        recordScalar("messagePoolAllocations", stats.allocations);
+        recordScalar("messagePoolReuses", stats.reuses);
+        recordScalar("messagePoolReuseRate", stats.allocations + stats.reuses > 0 ? (double) stats.reuses / (stats.allocations + stats.reuses) : 0);
+        recordScalar("messagePoolMaxLive", stats.maxLive);
+    }
+    if (commandInterface && commandInterface->isBatchingCommands()) {
+        const traci::CommandInterface::BatchStatistics& stats = commandInterface->getBatchStatistics();
+        recordScalar("batchFlushes", stats.flushes);
+        recordScalar("batchedCommands", stats.commands);
+        recordScalar("maxCommandsPerFlush", stats.maxCommandsPerFlush);
+        recordScalar("meanCommandsPerFlush", stats.flushes > 0 ? (double) stats.commands / stats.flushes : 0);
+    }
+    if (commandInterface && commandInterface->isShadowingParameters()) {
+        const traci::CommandInterface::ShadowStatistics& stats = commandInterface->getShadowStatistics();
+        recordScalar("shadowHits", stats.hits);
+        recordScalar("shadowMisses", stats.misses);
+        recordScalar("shadowVerifications", stats.verifications);
+        recordScalar("shadowMismatches", stats.mismatches);
+    }
+    if (commandInterface && commandInterface->isInstrumentingCommands()) {
+        // recordStatistic() needs a non-const statistic object
+        for (auto& command : commandInterface->getCommandStatistics()) {
+            traci::CommandInterface::CommandStatistics& stats = command.second;
+            recordScalar((command.first + "Calls").c_str(), stats.calls);
+            recordScalar((command.first + "BytesSent").c_str(), stats.bytesSent, "B");
+            recordScalar((command.first + "BytesReceived").c_str(), stats.bytesReceived, "B");
+            recordStatistic(&stats.latency, "s");
+        }
+    }
 }
 
 } // namespace plexe
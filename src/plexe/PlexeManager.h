@@ -28,11 +28,38 @@
 
 #include <plexe/mobility/CommandInterface.h>
 
+#include <chrono>
+#include <map>
+
 namespace plexe {
 
+class BaseProtocol;
+
 class PlexeManager : public cSimpleModule {
 public:
+    /**
+     * Emitted at the beginning of each time step, right before pending
+     * commands are sent to SUMO. Modules accumulating data during a time
+     * step can subscribe to this signal to push it to SUMO in time for
+     * the next simulation step
+     */
+    static const simsignal_t timestepBeginSignal;
+
+    /**
+     * Emitted when the fast-forward phase ends. Protocols start sending
+     * beacons and scenarios stop feeding controllers through SUMO
+     */
+    static const simsignal_t fastForwardEndSignal;
+
+    /**
+     * Emitted by the host module of each vehicle that SUMO reports as
+     * involved in a collision, at the end of the time step in which the
+     * collision happened. Only emitted if collisions are watched
+     */
+    static const simsignal_t collisionSignal;
+
     void initialize(int stage) override;
+    void finish() override;
 
     /**
      * Return a weak pointer to the CommandInterface owned by this manager.
@@ -42,9 +69,118 @@ public:
         return commandInterface.get();
     }
 
+    /**
+     * Returns whether the simulation is in the fast-forward phase, during
+     * which platooning beacons are not sent
+     */
+    bool isFastForwarding() const
+    {
+        return fastForwarding;
+    }
+
+    /**
+     * Returns whether collisions are detected by this manager, in which
+     * case the vehicles do not need to poll their crash state
+     */
+    bool isWatchingCollisions() const
+    {
+        return watchCollisions;
+    }
+
+    /**
+     * Ends the fast-forward phase before fastForwardUntil, e.g., when
+     * platoons reach a region of interest
+     */
+    void endFastForward();
+
+    /**
+     * Returns whether the simulation resumes from a checkpoint
+     */
+    bool isRestoringCheckpoint() const
+    {
+        return restoreCheckpoint;
+    }
+
+    /**
+     * Returns the time at which the checkpoint is taken or resumed
+     */
+    simtime_t getCheckpointTime() const
+    {
+        return checkpointAt;
+    }
+
+    /**
+     * Hands the state saved in the checkpoint to the protocol of a restored
+     * vehicle. Does nothing if the vehicle is not part of the checkpoint
+     */
+    void restoreProtocolState(int vehicleId, BaseProtocol* protocol);
+
 private:
     void initializeCommandInterface();
 
+    /**
+     * Tracks vehicle modules built and deleted by the scenario manager
+     */
+    void subscribeModuleChurn(veins::TraCIScenarioManager* scenarioManager);
+
+    /**
+     * Saves the state of SUMO and the platoon formations. Formations are
+     * taken from the position helpers of the vehicles, which are updated by
+     * maneuvers, falling back to the DynamicPositionManager
+     */
+    void saveCheckpoint();
+
+    /**
+     * Loads the state of SUMO and fills the DynamicPositionManager with the
+     * saved formations, so that vehicle modules built for the restored
+     * vehicles start as members of their platoons
+     */
+    void loadCheckpoint();
+
+    /**
+     * Returns the absolute path of a checkpoint file
+     */
+    std::string getCheckpointPath(const std::string& suffix) const;
+
+    std::string checkpointFile;
+    simtime_t checkpointAt;
+    bool restoreCheckpoint = false;
+    bool checkpointSaved = false;
+    // protocol state of the restored vehicles, until their modules are built
+    std::map<int, std::string> protocolStates;
+
+    /**
+     * Notifies the vehicles SUMO reports as involved in a collision
+     */
+    void checkCollisions();
+
+    bool watchCollisions = false;
+    // number of vehicles reported as involved in a collision
+    long collidingVehicles = 0;
+
+    simtime_t fastForwardUntil;
+    bool fastForwarding = false;
+    // wall clock time at the beginning of the simulation and at the end of the fast-forward phase
+    std::chrono::steady_clock::time_point wallClockStart;
+    std::chrono::steady_clock::time_point fastForwardEnd;
+    // simulation time at which the wall clock time is recorded, negative if disabled
+    simtime_t wallClockMark;
+    bool wallClockMarkReached = false;
+    std::chrono::steady_clock::time_point wallClockAtMark;
+
+    // modules built and deleted by the scenario manager
+    long modulesAdded = 0;
+    long modulesRemoved = 0;
+    // additions for which a module of the same type had already been deleted and could have been reused
+    long poolHits = 0;
+    // deleted modules not matched by an addition yet, per module type
+    std::map<std::string, long> idleModules;
+    long idleModulesCount = 0;
+    long maxIdleModules = 0;
+    // wall clock time spent in the initialization of a vehicle module
+    cHistogram moduleInitialization;
+    std::chrono::steady_clock::time_point moduleInitializationStart;
+
     std::unique_ptr<traci::CommandInterface> commandInterface;
     veins::SignalManager signalManager;
 };
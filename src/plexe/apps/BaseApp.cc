@@ -29,6 +29,7 @@
 #include "plexe/PlexeManager.h"
 
 #include "plexe/messages/PlexeInterfaceControlInfo_m.h"
+#include "plexe/utilities/MessagePool.h"
 
 using namespace veins;
 
@@ -52,6 +53,13 @@ void BaseApp::initialize(int stage)
         positionHelper = FindModule<BasePositionHelper*>::findSubModule(getParentModule());
         protocol = FindModule<BaseProtocol*>::findSubModule(getParentModule());
         myId = positionHelper->getId();
+
+        collisionsWatched = plexe->isWatchingCollisions();
+        if (collisionsWatched) {
+            // the signal is emitted by the host module of this vehicle
+            auto collision = [this](veins::SignalPayload<bool>) { onCollision(); };
+            signalManager.subscribeCallback(getParentModule(), PlexeManager::collisionSignal, collision);
+        }
     }
 }
 
@@ -98,6 +106,21 @@ void BaseApp::logVehicleData(bool crashed)
     posyOut.record(data.positionY);
 }
 
+void BaseApp::onCollision()
+{
+    // called by the PlexeManager while it processes the end of the time step
+    Enter_Method_Silent();
+    if (crashed) return;
+    if (recordData) {
+        logVehicleData(true);
+    }
+    else {
+        crashed = true;
+        stopSimulation = new cMessage("stopSimulation");
+        scheduleAt(simTime() + SimTime(1, SIMTIME_MS), stopSimulation);
+    }
+}
+
 void BaseApp::handleLowerControl(cMessage* msg)
 {
     delete msg;
@@ -109,7 +132,7 @@ void BaseApp::sendFrame(cPacket* msg, int destination, short type, enum PlexeRad
     PlexeInterfaceControlInfo* ctlInfo = new PlexeInterfaceControlInfo();
     ctlInfo->setInterfaces((int)interfaces);
 
-    BaseFrame1609_4* frame = new BaseFrame1609_4();
+    BaseFrame1609_4* frame = new Pooled<BaseFrame1609_4>();
     frame->setRecipientAddress(destination);
     // set kind to both the encapsulated packet and the outer frame
     frame->setKind(type);
@@ -124,7 +147,8 @@ void BaseApp::handleSelfMsg(cMessage* msg)
 {
     if (msg == recordData) {
         // log mobility data
-        logVehicleData(plexeTraciVehicle->isCrashed());
+        // crashes are either polled here or reported by the PlexeManager as they happen
+        logVehicleData(!collisionsWatched && plexeTraciVehicle->isCrashed());
         // re-schedule next event
         scheduleAt(simTime() + SimTime(100, SIMTIME_MS), recordData);
     }
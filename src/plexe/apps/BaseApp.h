@@ -30,6 +30,8 @@
 #include "plexe/utilities/BasePositionHelper.h"
 #include "plexe/driver/PlexeRadioDriverInterface.h"
 
+#include "veins/modules/utility/SignalManager.h"
+
 namespace plexe {
 
 class BaseProtocol;
@@ -61,6 +63,12 @@ protected:
      */
     virtual void logVehicleData(bool crashed = false);
 
+    /**
+     * Invoked when the PlexeManager reports this vehicle as involved in a
+     * collision. Logs the data of the collision and stops the simulation
+     */
+    virtual void onCollision();
+
     // output vectors for mobility stats
     // id of the vehicle
     cOutVector nodeIdOut;
@@ -77,6 +85,10 @@ protected:
     cMessage* stopSimulation;
 
     bool crashed = false;
+    // whether crashes are reported by the PlexeManager instead of being polled
+    bool collisionsWatched = false;
+
+    veins::SignalManager signalManager;
 
 public:
     BaseApp()
@@ -30,6 +30,7 @@
 #include "plexe/messages/PlexeInterfaceControlInfo_m.h"
 #include "veins/base/utils/FindModule.h"
 #include "plexe/scenarios/ManeuverScenario.h"
+#include "plexe/utilities/MessagePool.h"
 
 using namespace veins;
 
@@ -45,7 +46,10 @@ void GeneralPlatooningApp::initialize(int stage)
         // connect maneuver application to protocol
         protocol->registerApplication(MANEUVER_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"));
         // request beacons as well to be able to approach the platoon
-        protocol->registerApplication(BaseProtocol::BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"));
+        if (par("directDispatch").boolValue())
+            protocol->registerApplication(BaseProtocol::BEACON_TYPE, this);
+        else
+            protocol->registerApplication(BaseProtocol::BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"));
         // register to the signal indicating failed unicast transmissions
         findHost()->subscribe(Mac1609_4::sigRetriesExceeded, this);
 
@@ -202,6 +206,12 @@ void GeneralPlatooningApp::setPlatoonRole(PlatoonRole r)
     role = r;
 }
 
+void GeneralPlatooningApp::receiveFrame(std::shared_ptr<const BaseFrame1609_4> frame, enum PlexeRadioInterfaces interface)
+{
+    Enter_Method_Silent();
+    onPlatoonBeacon(check_and_cast<const PlatooningBeacon*>(frame->getEncapsulatedPacket()));
+}
+
 void GeneralPlatooningApp::onPlatoonBeacon(const PlatooningBeacon* pb)
 {
     joinManeuver->onPlatoonBeacon(pb);
@@ -231,7 +241,7 @@ void GeneralPlatooningApp::fillManeuverMessage(ManeuverMessage* msg, int vehicle
 
 UpdatePlatoonData* GeneralPlatooningApp::createUpdatePlatoonData(int vehicleId, std::string externalId, int platoonId, int destinationId, double platoonSpeed, int platoonLane, const std::vector<int>& platoonFormation, int newPlatoonId)
 {
-    UpdatePlatoonData* msg = new UpdatePlatoonData("UpdatePlatoonData");
+    UpdatePlatoonData* msg = new Pooled<UpdatePlatoonData>("UpdatePlatoonData");
     fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPlatoonSpeed(platoonSpeed);
     msg->setPlatoonLane(platoonLane);
@@ -245,7 +255,7 @@ UpdatePlatoonData* GeneralPlatooningApp::createUpdatePlatoonData(int vehicleId,
 
 UpdatePlatoonFormation* GeneralPlatooningApp::createUpdatePlatoonFormation(int vehicleId, std::string externalId, int platoonId, int destinationId, double platoonSpeed, int platoonLane, const std::vector<int>& platoonFormation)
 {
-    UpdatePlatoonFormation* msg = new UpdatePlatoonFormation("UpdatePlatoonFormation");
+    UpdatePlatoonFormation* msg = new Pooled<UpdatePlatoonFormation>("UpdatePlatoonFormation");
     fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPlatoonSpeed(platoonSpeed);
     msg->setPlatoonLane(platoonLane);
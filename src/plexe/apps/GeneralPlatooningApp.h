@@ -26,6 +26,7 @@
 #include <memory>
 
 #include "plexe/apps/BaseApp.h"
+#include "plexe/protocols/FrameReceiver.h"
 #include "plexe/maneuver/JoinManeuver.h"
 #include "plexe/maneuver/JoinAtBack.h"
 #include "plexe/maneuver/MergeAtBack.h"
@@ -63,7 +64,7 @@ enum class PlatoonRole : size_t {
  * @see JoinAtBack
  * @see ManeuverMessage
  */
-class GeneralPlatooningApp : public BaseApp {
+class GeneralPlatooningApp : public BaseApp, public FrameReceiver {
 
 public:
     /** c'tor for GeneralPlatooningApp */
@@ -268,12 +269,17 @@ public:
      */
     enum ACTIVE_CONTROLLER getTargetController();
 
+    /** receives beacons directly from the protocol */
+    void receiveFrame(std::shared_ptr<const veins::BaseFrame1609_4> frame, enum PlexeRadioInterfaces interface) override;
+
 protected:
     /** override this method of BaseApp. we want to handle it ourself */
     virtual void handleLowerMsg(cMessage* msg) override;
 
     /**
-     * Handles PlatoonBeacons
+     * Handles PlatoonBeacons. The beacon is owned by the caller: overriding
+     * methods must neither delete the beacon nor keep a pointer to it, as
+     * with direct dispatch it is shared with other applications
      *
      * @param PlatooningBeacon pb to handle
      */
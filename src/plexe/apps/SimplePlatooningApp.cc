@@ -20,6 +20,11 @@
 
 #include "plexe/apps/SimplePlatooningApp.h"
 #include "plexe/protocols/BaseProtocol.h"
+#include "plexe/PlexeManager.h"
+
+#include "veins/base/utils/FindModule.h"
+
+#include <vector>
 
 namespace plexe {
 
@@ -32,8 +37,19 @@ void SimplePlatooningApp::initialize(int stage)
 
     if (stage == 1) {
         // connect application to protocol
-        protocol->registerApplication(BaseProtocol::BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"));
-        enableLogging();
+        if (par("directDispatch").boolValue())
+            protocol->registerApplication(BaseProtocol::BEACON_TYPE, this);
+        else
+            protocol->registerApplication(BaseProtocol::BEACON_TYPE, gate("lowerLayerIn"), gate("lowerLayerOut"), gate("lowerControlIn"), gate("lowerControlOut"));
+        if (par("enableLogging").boolValue()) enableLogging();
+
+        accumulateBeacons = par("accumulateBeacons").boolValue();
+        if (accumulateBeacons) {
+            auto plexe = veins::FindModule<PlexeManager*>::findGlobalModule();
+            ASSERT(plexe);
+            auto push = [this](veins::SignalPayload<simtime_t const&>) { pushAccumulatedData(); };
+            signalManager.subscribeCallback(plexe, PlexeManager::timestepBeginSignal, push);
+        }
     }
 }
 
@@ -54,19 +70,21 @@ void SimplePlatooningApp::handleLowerMsg(cMessage* msg)
     delete frame;
 }
 
+void SimplePlatooningApp::receiveFrame(std::shared_ptr<const BaseFrame1609_4> frame, enum PlexeRadioInterfaces interface)
+{
+    Enter_Method_Silent();
+    processPlatoonBeacon(check_and_cast<const PlatooningBeacon*>(frame->getEncapsulatedPacket()));
+}
+
 void SimplePlatooningApp::onPlatoonBeacon(const PlatooningBeacon* pb)
+{
+    processPlatoonBeacon(pb);
+    delete pb;
+}
+
+void SimplePlatooningApp::processPlatoonBeacon(const PlatooningBeacon* pb)
 {
     if (positionHelper->isInSamePlatoon(pb->getVehicleId())) {
-        // if the message comes from the leader
-        if (pb->getVehicleId() == positionHelper->getLeaderId()) {
-            plexeTraciVehicle->setLeaderVehicleData(pb->getControllerAcceleration(), pb->getAcceleration(), pb->getSpeed(), pb->getPositionX(), pb->getPositionY(), pb->getTime());
-        }
-        // if the message comes from the vehicle in front
-        if (pb->getVehicleId() == positionHelper->getFrontId()) {
-            plexeTraciVehicle->setFrontVehicleData(pb->getControllerAcceleration(), pb->getAcceleration(), pb->getSpeed(), pb->getPositionX(), pb->getPositionY(), pb->getTime());
-        }
-        // send data about every vehicle to the CACC controllers
-        // controllers will then pick the data of vehicles they are interested in
         struct VEHICLE_DATA vehicleData;
         vehicleData.index = positionHelper->getMemberPosition(pb->getVehicleId());
         vehicleData.acceleration = pb->getAcceleration();
@@ -79,10 +97,41 @@ void SimplePlatooningApp::onPlatoonBeacon(const PlatooningBeacon* pb)
         vehicleData.speedX = pb->getSpeedX();
         vehicleData.speedY = pb->getSpeedY();
         vehicleData.angle = pb->getAngle();
-        // send information to CACC controllers
+        if (accumulateBeacons) {
+            // only the most recent data matters to the controllers
+            accumulatedData[pb->getVehicleId()] = vehicleData;
+            if (pb->getVehicleId() == positionHelper->getLeaderId()) accumulatedLeaderId = pb->getVehicleId();
+            if (pb->getVehicleId() == positionHelper->getFrontId()) accumulatedFrontId = pb->getVehicleId();
+            return;
+        }
+        // if the message comes from the leader
+        if (pb->getVehicleId() == positionHelper->getLeaderId()) {
+            plexeTraciVehicle->setLeaderVehicleData(pb->getControllerAcceleration(), pb->getAcceleration(), pb->getSpeed(), pb->getPositionX(), pb->getPositionY(), pb->getTime());
+        }
+        // if the message comes from the vehicle in front
+        if (pb->getVehicleId() == positionHelper->getFrontId()) {
+            plexeTraciVehicle->setFrontVehicleData(pb->getControllerAcceleration(), pb->getAcceleration(), pb->getSpeed(), pb->getPositionX(), pb->getPositionY(), pb->getTime());
+        }
+        // send data about every vehicle to the CACC controllers
+        // controllers will then pick the data of vehicles they are interested in
         plexeTraciVehicle->setVehicleData(&vehicleData);
     }
-    delete pb;
+}
+
+void SimplePlatooningApp::pushAccumulatedData()
+{
+    if (accumulatedData.empty()) return;
+
+    std::vector<struct VEHICLE_DATA> data;
+    data.reserve(accumulatedData.size());
+    for (const auto& vehicleData : accumulatedData) data.push_back(vehicleData.second);
+    const struct VEHICLE_DATA* leaderData = accumulatedLeaderId != -1 ? &accumulatedData[accumulatedLeaderId] : nullptr;
+    const struct VEHICLE_DATA* frontData = accumulatedFrontId != -1 ? &accumulatedData[accumulatedFrontId] : nullptr;
+    plexeTraciVehicle->setPlatoonVehicleData(data, leaderData, frontData);
+
+    accumulatedData.clear();
+    accumulatedLeaderId = -1;
+    accumulatedFrontId = -1;
 }
 
 } // namespace plexe
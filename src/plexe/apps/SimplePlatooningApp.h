@@ -21,25 +21,58 @@
 #pragma once
 
 #include "plexe/apps/BaseApp.h"
+#include "plexe/protocols/FrameReceiver.h"
+
+#include <map>
 
 namespace plexe {
 
-class SimplePlatooningApp : public BaseApp {
+class SimplePlatooningApp : public BaseApp, public FrameReceiver {
 
 public:
     SimplePlatooningApp()
+        : accumulateBeacons(false)
+        , accumulatedLeaderId(-1)
+        , accumulatedFrontId(-1)
     {
     }
     virtual void initialize(int stage) override;
 
+    void receiveFrame(std::shared_ptr<const veins::BaseFrame1609_4> frame, enum PlexeRadioInterfaces interface) override;
+
 protected:
     virtual void handleLowerMsg(cMessage* msg) override;
 
     /**
-     * Handles PlatoonBeacons
+     * Handles PlatoonBeacons received through gates. This method takes
+     * ownership of the beacon: it processes it with processPlatoonBeacon()
+     * and then deletes it
      */
     virtual void onPlatoonBeacon(const PlatooningBeacon* pb);
 
+    /**
+     * Passes the data of a PlatoonBeacon to the controllers. The beacon is
+     * owned by the caller. With directDispatch, beacons are delivered here
+     * without going through onPlatoonBeacon() and are shared with other
+     * applications: overriding methods must neither delete the beacon nor
+     * keep a pointer to it
+     */
+    virtual void processPlatoonBeacon(const PlatooningBeacon* pb);
+
+    /**
+     * Sends the data accumulated during the current time step to the
+     * controllers with a single command
+     */
+    void pushAccumulatedData();
+
+    // collect beacons received within a time step and push them at once
+    bool accumulateBeacons;
+    // latest data received from each platoon member in the current time step, indexed by vehicle id
+    std::map<int, struct VEHICLE_DATA> accumulatedData;
+    // ids of the leader and of the front vehicle when their data was accumulated, -1 if none
+    int accumulatedLeaderId;
+    int accumulatedFrontId;
+
 };
 
 } // namespace plexe
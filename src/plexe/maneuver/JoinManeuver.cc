@@ -21,6 +21,7 @@
 
 #include "plexe/maneuver/JoinManeuver.h"
 #include "plexe/apps/GeneralPlatooningApp.h"
+#include "plexe/utilities/MessagePool.h"
 
 namespace plexe {
 
@@ -56,7 +57,7 @@ void JoinManeuver::onManeuverMessage(const ManeuverMessage* mm)
 
 JoinPlatoonRequest* JoinManeuver::createJoinPlatoonRequest(int vehicleId, std::string externalId, int platoonId, int destinationId, int currentLaneIndex, double xPos, double yPos)
 {
-    JoinPlatoonRequest* msg = new JoinPlatoonRequest("JoinPlatoonRequest");
+    JoinPlatoonRequest* msg = new Pooled<JoinPlatoonRequest>("JoinPlatoonRequest");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setCurrentLaneIndex(currentLaneIndex);
     msg->setXPos(xPos);
@@ -66,7 +67,7 @@ JoinPlatoonRequest* JoinManeuver::createJoinPlatoonRequest(int vehicleId, std::s
 
 MergePlatoonRequest* JoinManeuver::createMergePlatoonRequest(int vehicleId, std::string externalId, int platoonId, int destinationId, int currentLaneIndex, double xPos, double yPos, const std::vector<int>& members)
 {
-    MergePlatoonRequest* msg = new MergePlatoonRequest("MergePlatoonRequest");
+    MergePlatoonRequest* msg = new Pooled<MergePlatoonRequest>("MergePlatoonRequest");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setCurrentLaneIndex(currentLaneIndex);
     msg->setXPos(xPos);
@@ -81,7 +82,7 @@ MergePlatoonRequest* JoinManeuver::createMergePlatoonRequest(int vehicleId, std:
 
 JoinPlatoonResponse* JoinManeuver::createJoinPlatoonResponse(int vehicleId, std::string externalId, int platoonId, int destinationId, bool permitted)
 {
-    JoinPlatoonResponse* msg = new JoinPlatoonResponse("JoinPlatoonResponse");
+    JoinPlatoonResponse* msg = new Pooled<JoinPlatoonResponse>("JoinPlatoonResponse");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPermitted(permitted);
     return msg;
@@ -89,7 +90,7 @@ JoinPlatoonResponse* JoinManeuver::createJoinPlatoonResponse(int vehicleId, std:
 
 MoveToPosition* JoinManeuver::createMoveToPosition(int vehicleId, std::string externalId, int platoonId, int destinationId, double platoonSpeed, int platoonLane, const std::vector<int>& newPlatoonFormation)
 {
-    MoveToPosition* msg = new MoveToPosition("MoveToPosition");
+    MoveToPosition* msg = new Pooled<MoveToPosition>("MoveToPosition");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPlatoonSpeed(platoonSpeed);
     msg->setPlatoonLane(platoonLane);
@@ -102,7 +103,7 @@ MoveToPosition* JoinManeuver::createMoveToPosition(int vehicleId, std::string ex
 
 MoveToPositionAck* JoinManeuver::createMoveToPositionAck(int vehicleId, std::string externalId, int platoonId, int destinationId, double platoonSpeed, int platoonLane, const std::vector<int>& newPlatoonFormation)
 {
-    MoveToPositionAck* msg = new MoveToPositionAck("MoveToPositionAck");
+    MoveToPositionAck* msg = new Pooled<MoveToPositionAck>("MoveToPositionAck");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPlatoonSpeed(platoonSpeed);
     msg->setPlatoonLane(platoonLane);
@@ -115,7 +116,7 @@ MoveToPositionAck* JoinManeuver::createMoveToPositionAck(int vehicleId, std::str
 
 JoinFormation* JoinManeuver::createJoinFormation(int vehicleId, std::string externalId, int platoonId, int destinationId, double platoonSpeed, int platoonLane, const std::vector<int>& newPlatoonFormation)
 {
-    JoinFormation* msg = new JoinFormation("JoinFormation");
+    JoinFormation* msg = new Pooled<JoinFormation>("JoinFormation");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPlatoonSpeed(platoonSpeed);
     msg->setPlatoonLane(platoonLane);
@@ -128,7 +129,7 @@ JoinFormation* JoinManeuver::createJoinFormation(int vehicleId, std::string exte
 
 JoinFormationAck* JoinManeuver::createJoinFormationAck(int vehicleId, std::string externalId, int platoonId, int destinationId, double platoonSpeed, int platoonLane, const std::vector<int>& newPlatoonFormation)
 {
-    JoinFormationAck* msg = new JoinFormationAck("JoinFormationAck");
+    JoinFormationAck* msg = new Pooled<JoinFormationAck>("JoinFormationAck");
     app->fillManeuverMessage(msg, vehicleId, externalId, platoonId, destinationId);
     msg->setPlatoonSpeed(platoonSpeed);
     msg->setPlatoonLane(platoonLane);
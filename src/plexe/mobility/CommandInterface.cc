@@ -19,11 +19,16 @@
 //
 
 #include "CommandInterface.h"
+#include "plexe/mobility/FastParBuffer.h"
 
 #include <veins/modules/mobility/traci/TraCIConnection.h>
 #include <veins/modules/mobility/traci/TraCIConstants.h>
 #include <veins/modules/mobility/traci/ParBuffer.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
 using veins::ParBuffer;
 using veins::TraCIBuffer;
 using namespace veins::TraCIConstants;
@@ -35,20 +40,567 @@ CommandInterface::CommandInterface(cComponent* owner, veins::TraCICommandInterfa
     : HasLogProxy(owner)
     , veinsCommandInterface(veinsCommandInterface)
     , connection(connection)
+    , batchCommands(false)
+    , nPendingCommands(0)
+    , useSubscriptions(false)
+    , shadowParameters(false)
+    , shadowVerificationInterval(0)
+    , fastParameterEncoding(false)
+    , instrumentCommands(false)
+    , currentCommand(nullptr)
+{
+}
+
+void CommandInterface::setBatchCommands(bool batch)
+{
+    if (!batch) flushCommands();
+    batchCommands = batch;
+}
+
+void CommandInterface::sendCommand(uint8_t commandId, const TraCIBuffer& buf)
+{
+    if (!batchCommands) {
+        TraCIBuffer response = connection->query(commandId, buf);
+        ASSERT(response.eof());
+        if (currentCommand) countTraffic(veins::makeTraCICommand(commandId, buf).size(), 0);
+        return;
+    }
+    pendingCommands += veins::makeTraCICommand(commandId, buf);
+    nPendingCommands++;
+}
+
+TraCIBuffer CommandInterface::query(uint8_t commandId, const TraCIBuffer& buf)
+{
+    // make sure that SUMO has processed all our commands before reading any value
+    flushCommands();
+    TraCIBuffer response = connection->query(commandId, buf);
+    if (currentCommand) countTraffic(veins::makeTraCICommand(commandId, buf).size(), response.str().size());
+    return response;
+}
+
+namespace {
+
+/**
+ * Reads the status response of a command and returns its result code
+ */
+uint8_t readStatus(TraCIBuffer& buf, uint8_t& commandId, std::string& description)
+{
+    uint8_t cmdLength;
+    buf >> cmdLength;
+    if (cmdLength == 0) {
+        int32_t cmdLengthExt;
+        buf >> cmdLengthExt;
+    }
+    buf >> commandId;
+    uint8_t result;
+    buf >> result;
+    buf >> description;
+    return result;
+}
+
+/**
+ * Reads the response to a get command for a vehicle parameter and returns its value
+ */
+std::string readParameterResponse(TraCIBuffer& buf)
+{
+    uint8_t cmdLength;
+    buf >> cmdLength;
+    if (cmdLength == 0) {
+        int32_t cmdLengthExt;
+        buf >> cmdLengthExt;
+    }
+    uint8_t responseId;
+    buf >> responseId;
+    ASSERT(responseId == RESPONSE_GET_VEHICLE_VARIABLE);
+    uint8_t variable;
+    buf >> variable;
+    ASSERT(variable == VAR_PARAMETER);
+    std::string id;
+    buf >> id;
+    uint8_t type;
+    buf >> type;
+    ASSERT(type == TYPE_STRING);
+    std::string value;
+    buf >> value;
+    return value;
+}
+
+/**
+ * Encodes the data of the leader or of the front vehicle
+ */
+template <typename Buffer>
+std::string encodeLeaderOrFrontData(double controllerAcceleration, double acceleration, double speed, double positionX, double positionY, double time)
+{
+    Buffer buf;
+    buf << speed << acceleration << positionX << positionY << time << controllerAcceleration;
+    return buf.str();
+}
+
+/**
+ * Decodes the data of a vehicle as returned by PAR_SPEED_AND_ACCELERATION
+ */
+template <typename Buffer>
+void decodeVehicleData(const std::string& v, VEHICLE_DATA* data)
+{
+    Buffer buf(v);
+    buf >> data->speed >> data->acceleration >> data->u >> data->positionX >> data->positionY >> data->time >> data->speedX >> data->speedY >> data->angle;
+}
+
+/**
+ * Encodes the data of a platoon member as expected by CC_PAR_VEHICLE_DATA
+ */
+template <typename Buffer>
+std::string encodeStoredVehicleData(const VEHICLE_DATA* data)
+{
+    Buffer buf;
+    buf << data->index << data->speed << data->acceleration << data->positionX << data->positionY << data->time << data->length << data->u << data->speedX << data->speedY << data->angle;
+    return buf.str();
+}
+
+/**
+ * Decodes the data of a platoon member as returned by CC_PAR_VEHICLE_DATA
+ */
+template <typename Buffer>
+void decodeStoredVehicleData(const std::string& v, VEHICLE_DATA* data)
+{
+    Buffer buf(v);
+    buf >> data->index >> data->speed >> data->acceleration >> data->positionX >> data->positionY >> data->time >> data->length >> data->u >> data->speedX >> data->speedY >> data->angle;
+}
+
+} // namespace
+
+void CommandInterface::flushCommands()
+{
+    if (nPendingCommands == 0) return;
+
+    CommandScope scope(this, __func__);
+    connection->sendMessage(pendingCommands);
+    std::string message = connection->receiveMessage();
+    if (currentCommand) countTraffic(pendingCommands.size(), message.size());
+    TraCIBuffer response(message);
+    readPendingCommandsStatus(response);
+    ASSERT(response.eof());
+}
+
+void CommandInterface::readPendingCommandsStatus(TraCIBuffer& response)
+{
+    if (nPendingCommands == 0) return;
+
+    // set commands only get a status response, one for each command in the message
+    for (int i = 0; i < nPendingCommands; i++) {
+        uint8_t commandResp;
+        std::string description;
+        uint8_t result = readStatus(response, commandResp, description);
+        if (result == RTYPE_NOTIMPLEMENTED) throw cRuntimeError("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", commandResp, description.c_str());
+        if (result == RTYPE_ERR) throw cRuntimeError("TraCI server reported error executing command 0x%2x (\"%s\").", commandResp, description.c_str());
+        ASSERT(result == RTYPE_OK);
+    }
+
+    batchStatistics.flushes++;
+    batchStatistics.commands += nPendingCommands;
+    batchStatistics.maxCommandsPerFlush = std::max(batchStatistics.maxCommandsPerFlush, (long) nPendingCommands);
+
+    pendingCommands.clear();
+    nPendingCommands = 0;
+}
+
+std::vector<std::string> CommandInterface::getCollidingVehicles()
+{
+    CommandScope scope(this, __func__);
+    TraCIBuffer response = query(CMD_GET_SIM_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_COLLIDING_VEHICLES_IDS) << std::string(""));
+
+    uint8_t cmdLength;
+    response >> cmdLength;
+    if (cmdLength == 0) {
+        int32_t cmdLengthExt;
+        response >> cmdLengthExt;
+    }
+    uint8_t responseId;
+    response >> responseId;
+    ASSERT(responseId == RESPONSE_GET_SIM_VARIABLE);
+    uint8_t variable;
+    response >> variable;
+    ASSERT(variable == VAR_COLLIDING_VEHICLES_IDS);
+    std::string id;
+    response >> id;
+    uint8_t type;
+    response >> type;
+    ASSERT(type == TYPE_STRINGLIST);
+    int32_t count;
+    response >> count;
+    std::vector<std::string> vehicles(count);
+    for (auto& vehicle : vehicles) response >> vehicle;
+    ASSERT(response.eof());
+    return vehicles;
+}
+
+void CommandInterface::saveState(const std::string& fileName)
+{
+    TraCIBuffer response = query(CMD_SET_SIM_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_SAVE_SIMSTATE) << std::string("") << static_cast<uint8_t>(TYPE_STRING) << fileName);
+    ASSERT(response.eof());
+}
+
+void CommandInterface::loadState(const std::string& fileName)
+{
+    TraCIBuffer response = query(CMD_SET_SIM_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_LOAD_SIMSTATE) << std::string("") << static_cast<uint8_t>(TYPE_STRING) << fileName);
+    ASSERT(response.eof());
+    // subscribed data and shadowed parameters refer to the state before loading
+    subscriptions.clear();
+    shadowValues.clear();
+    platoonMembers.clear();
+}
+
+void CommandInterface::setInstrumentCommands(bool instrument)
+{
+    instrumentCommands = instrument;
+}
+
+void CommandInterface::countTraffic(size_t sent, size_t received)
+{
+    // the four bytes of the message length header are not included
+    currentCommand->bytesSent += sent;
+    currentCommand->bytesReceived += received;
+}
+
+CommandInterface::CommandScope::CommandScope(CommandInterface* cifc, const char* command)
+    : cifc(cifc)
+    , statistics(nullptr)
+{
+    // nested calls are accounted to the outermost command
+    if (!cifc->instrumentCommands || cifc->currentCommand) return;
+    auto found = cifc->commandStatistics.find(command);
+    if (found == cifc->commandStatistics.end()) {
+        found = cifc->commandStatistics.emplace(command, CommandStatistics()).first;
+        found->second.latency.setName((std::string(command) + "Latency").c_str());
+    }
+    statistics = &found->second;
+    statistics->calls++;
+    cifc->currentCommand = statistics;
+    start = std::chrono::steady_clock::now();
+}
+
+CommandInterface::CommandScope::~CommandScope()
+{
+    if (!statistics) return;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    statistics->latency.collect(elapsed.count());
+    cifc->currentCommand = nullptr;
+}
+
+void CommandInterface::setUseSubscriptions(bool use)
+{
+    useSubscriptions = use;
+    if (!use) subscriptions.clear();
+}
+
+void CommandInterface::invalidateSubscriptions()
+{
+    for (auto subscription = subscriptions.begin(); subscription != subscriptions.end();) {
+        // drop vehicles that left the simulation. they are subscribed again if accessed
+        if (subscription->second.valid && !subscription->second.available) {
+            subscription = subscriptions.erase(subscription);
+        }
+        else {
+            subscription->second.valid = false;
+            subscription++;
+        }
+    }
+}
+
+void CommandInterface::prefetchSubscriptions(const std::vector<std::string>& nodeIds)
+{
+    if (!useSubscriptions) return;
+    CommandScope scope(this, __func__);
+    for (const auto& nodeId : nodeIds) subscriptions.emplace(nodeId, Subscription());
+    updateSubscriptions();
+}
+
+const CommandInterface::Subscription* CommandInterface::getSubscription(const std::string& nodeId)
+{
+    auto subscription = subscriptions.find(nodeId);
+    if (subscription == subscriptions.end()) {
+        // first access subscribes the vehicle
+        subscription = subscriptions.emplace(nodeId, Subscription()).first;
+    }
+    if (!subscription->second.valid) updateSubscriptions();
+    // SUMO refused to provide the data in this time step
+    if (!subscription->second.available) return nullptr;
+    return &subscription->second;
+}
+
+void CommandInterface::updateSubscriptions()
+{
+    static const std::string parameters[] = {PAR_SPEED_AND_ACCELERATION, PAR_RADAR_DATA, PAR_CRASHED};
+    const int nParameters = sizeof(parameters) / sizeof(*parameters);
+
+    // query the data of all outdated subscriptions at once
+    std::vector<std::string> nodeIds;
+    std::string queries;
+    for (auto& subscription : subscriptions) {
+        if (subscription.second.valid) continue;
+        nodeIds.push_back(subscription.first);
+        for (int i = 0; i < nParameters; i++) {
+            queries += veins::makeTraCICommand(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << subscription.first << static_cast<uint8_t>(TYPE_STRING) << parameters[i]);
+        }
+    }
+    if (nodeIds.empty()) return;
+
+    // pending set commands travel in the same message, ahead of the queries
+    CommandScope scope(this, __func__);
+    connection->sendMessage(pendingCommands + queries);
+    std::string message = connection->receiveMessage();
+    if (currentCommand) countTraffic(pendingCommands.size() + queries.size(), message.size());
+    TraCIBuffer response(message);
+    readPendingCommandsStatus(response);
+
+    for (auto& nodeId : nodeIds) {
+        std::string values[nParameters];
+        bool success = true;
+        for (int i = 0; i < nParameters; i++) {
+            uint8_t commandResp;
+            std::string description;
+            // failed queries only get the status response
+            if (readStatus(response, commandResp, description) != RTYPE_OK) {
+                success = false;
+                continue;
+            }
+            values[i] = readParameterResponse(response);
+        }
+        Subscription& subscription = subscriptions[nodeId];
+        subscription.valid = true;
+        // the vehicle left the simulation or is not controlled by Plexe
+        subscription.available = success;
+        if (!success) continue;
+        if (fastParameterEncoding) decodeVehicleData<FastParBuffer>(values[0], &subscription.vehicleData);
+        else decodeVehicleData<ParBuffer>(values[0], &subscription.vehicleData);
+        ParBuffer(values[1]) >> subscription.radarDistance >> subscription.radarRelativeSpeed;
+        int crashed;
+        ParBuffer(values[2]) >> crashed;
+        subscription.crashed = crashed;
+    }
+    ASSERT(response.eof());
+}
+
+namespace {
+
+/**
+ * Formats the departure lane, position, or speed of a vehicle for ADD_FULL.
+ * Negative values select the given SUMO default
+ */
+std::string departValue(double value, const char* negative)
+{
+    return value < 0 ? negative : std::to_string(value);
+}
+
+} // namespace
+
+void CommandInterface::addVehicles(const std::vector<InsertionEngine::Insertion>& insertions, std::vector<bool>& success)
+{
+    CommandScope scope(this, __func__);
+
+    // one ADD_FULL command per vehicle, all within a single message
+    std::string commands;
+    for (const auto& insertion : insertions) {
+        TraCIBuffer buf;
+        buf << static_cast<uint8_t>(ADD_FULL) << *insertion.vehicleId << static_cast<uint8_t>(TYPE_COMPOUND) << static_cast<int32_t>(14);
+        std::string lane = insertion.lane < 0 ? "first" : std::to_string(insertion.lane);
+        // route, type, depart, departLane, departPos, departSpeed, arrivalLane, arrivalPos, arrivalSpeed, fromTaz, toTaz, line
+        const std::string values[] = {*insertion.route, *insertion.vehicleType, "now", lane, departValue(insertion.position, "base"), departValue(insertion.speed, "max"), "current", "max", "current", "", "", ""};
+        for (const auto& value : values) buf << static_cast<uint8_t>(TYPE_STRING) << value;
+        // person capacity and person number
+        buf << static_cast<uint8_t>(TYPE_INTEGER) << static_cast<int32_t>(0) << static_cast<uint8_t>(TYPE_INTEGER) << static_cast<int32_t>(0);
+        commands += veins::makeTraCICommand(CMD_SET_VEHICLE_VARIABLE, buf);
+    }
+
+    // pending set commands travel in the same message, ahead of the insertions
+    connection->sendMessage(pendingCommands + commands);
+    std::string message = connection->receiveMessage();
+    if (currentCommand) countTraffic(pendingCommands.size() + commands.size(), message.size());
+    TraCIBuffer response(message);
+    readPendingCommandsStatus(response);
+
+    for (const auto& insertion : insertions) {
+        uint8_t commandResp;
+        std::string description;
+        uint8_t result = readStatus(response, commandResp, description);
+        ASSERT(commandResp == CMD_SET_VEHICLE_VARIABLE);
+        if (result == RTYPE_NOTIMPLEMENTED) throw cRuntimeError("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", commandResp, description.c_str());
+        // SUMO refuses vehicles that do not fit, which is not an error for the caller
+        if (result != RTYPE_OK) EV_DEBUG << "Cannot insert " << *insertion.vehicleId << ": " << description << "\n";
+        success.push_back(result == RTYPE_OK);
+    }
+    ASSERT(response.eof());
+}
+
+void CommandInterface::removeVehicles(const std::vector<InsertionEngine::Insertion>& insertions)
+{
+    CommandScope scope(this, __func__);
+
+    std::string commands;
+    for (const auto& insertion : insertions) {
+        TraCIBuffer buf;
+        buf << static_cast<uint8_t>(REMOVE) << *insertion.vehicleId << static_cast<uint8_t>(TYPE_BYTE) << static_cast<uint8_t>(REMOVE_VAPORIZED);
+        commands += veins::makeTraCICommand(CMD_SET_VEHICLE_VARIABLE, buf);
+    }
+
+    connection->sendMessage(pendingCommands + commands);
+    std::string message = connection->receiveMessage();
+    if (currentCommand) countTraffic(pendingCommands.size() + commands.size(), message.size());
+    TraCIBuffer response(message);
+    readPendingCommandsStatus(response);
+
+    for (const auto& insertion : insertions) {
+        uint8_t commandResp;
+        std::string description;
+        uint8_t result = readStatus(response, commandResp, description);
+        ASSERT(commandResp == CMD_SET_VEHICLE_VARIABLE);
+        if (result != RTYPE_OK) throw cRuntimeError("Cannot remove vehicle %s: %s", insertion.vehicleId->c_str(), description.c_str());
+    }
+    ASSERT(response.eof());
+}
+
+void CommandInterface::registerControllerProfile(const std::string& name, const ControllerProfile& profile)
+{
+    auto registered = controllerProfiles.find(name);
+    if (registered != controllerProfiles.end()) {
+        if (registered->second.profile != profile) throw cRuntimeError("Controller profile \"%s\" registered twice with different parameters", name.c_str());
+        return;
+    }
+    RegisteredProfile& entry = controllerProfiles[name];
+    entry.profile = profile;
+    int32_t nParameters = 2;
+    for (const auto& parameter : profile) {
+        TraCIBuffer buf;
+        buf << static_cast<uint8_t>(TYPE_COMPOUND) << nParameters << static_cast<uint8_t>(TYPE_STRING) << parameter.first << static_cast<uint8_t>(TYPE_STRING) << parameter.second;
+        entry.encodedParameters.push_back(buf.str());
+    }
+}
+
+void CommandInterface::setParameter(const std::string& nodeId, const std::string& parameter, const std::string& value)
+{
+    int32_t nParameters = 2;
+    sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_COMPOUND) << nParameters << static_cast<uint8_t>(TYPE_STRING) << parameter << static_cast<uint8_t>(TYPE_STRING) << value);
+    // store the value as sent, so that reads return exactly what SUMO parsed
+    if (shadowParameters && isShadowedParameter(parameter)) shadowValues[nodeId][parameter] = value;
+}
+
+void CommandInterface::setParameter(const std::string& nodeId, const std::string& parameter, int value)
+{
+    std::stringstream strValue;
+    strValue << value;
+    setParameter(nodeId, parameter, strValue.str());
+}
+
+void CommandInterface::setParameter(const std::string& nodeId, const std::string& parameter, double value)
+{
+    std::stringstream strValue;
+    strValue << value;
+    setParameter(nodeId, parameter, strValue.str());
+}
+
+namespace {
+
+/**
+ * Compares two parameter values numerically if both are numbers, so that
+ * "1" and "1.0" are equal, and as strings otherwise
+ */
+bool sameParameterValue(const std::string& a, const std::string& b)
+{
+    char* endA;
+    char* endB;
+    double numberA = std::strtod(a.c_str(), &endA);
+    double numberB = std::strtod(b.c_str(), &endB);
+    if (endA == a.c_str() || *endA != '\0' || endB == b.c_str() || *endB != '\0') return a == b;
+    return numberA == numberB;
+}
+
+} // namespace
+
+void CommandInterface::getParameter(const std::string& nodeId, const std::string& parameter, std::string& value)
+{
+    if (!shadowParameters || !isShadowedParameter(parameter)) {
+        fetchParameter(nodeId, parameter, value);
+        return;
+    }
+
+    auto& vehicleValues = shadowValues[nodeId];
+    auto shadowValue = vehicleValues.find(parameter);
+    if (shadowValue == vehicleValues.end()) {
+        // never set by Plexe: ask SUMO once and remember its default
+        shadowStatistics.misses++;
+        fetchParameter(nodeId, parameter, value);
+        vehicleValues[parameter] = value;
+        return;
+    }
+
+    shadowStatistics.hits++;
+    value = shadowValue->second;
+    if (shadowVerificationInterval > 0 && shadowStatistics.hits % shadowVerificationInterval == 0) {
+        std::string sumoValue;
+        fetchParameter(nodeId, parameter, sumoValue);
+        shadowStatistics.verifications++;
+        if (!sameParameterValue(sumoValue, value)) {
+            shadowStatistics.mismatches++;
+            EV_WARN << "shadow value of " << parameter << " for vehicle " << nodeId << " is " << value << " but SUMO reports " << sumoValue << "\n";
+            shadowValue->second = sumoValue;
+            value = sumoValue;
+        }
+    }
+}
+
+void CommandInterface::fetchParameter(const std::string& nodeId, const std::string& parameter, std::string& value)
+{
+    TraCIBuffer response = query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId << static_cast<uint8_t>(TYPE_STRING) << parameter);
+    value = readParameterResponse(response);
+    ASSERT(response.eof());
+}
+
+void CommandInterface::getParameter(const std::string& nodeId, const std::string& parameter, int& value)
 {
+    std::string strValue;
+    getParameter(nodeId, parameter, strValue);
+    std::istringstream(strValue) >> value;
+}
+
+void CommandInterface::getParameter(const std::string& nodeId, const std::string& parameter, double& value)
+{
+    std::string strValue;
+    getParameter(nodeId, parameter, strValue);
+    std::istringstream(strValue) >> value;
+}
+
+bool CommandInterface::isShadowedParameter(const std::string& parameter)
+{
+    // controller parameters that only Plexe modifies
+    return parameter == PAR_CC_DESIRED_SPEED || parameter == PAR_ACTIVE_CONTROLLER || parameter == PAR_ACC_HEADWAY_TIME || parameter == PAR_CACC_SPACING;
+}
+
+void CommandInterface::setShadowParameters(bool shadow, int verificationInterval)
+{
+    ASSERT(verificationInterval >= 0);
+    shadowParameters = shadow;
+    shadowVerificationInterval = verificationInterval;
+    if (!shadow) shadowValues.clear();
+}
+
+void CommandInterface::forgetVehicle(const std::string& nodeId)
+{
+    shadowValues.erase(nodeId);
+    platoonMembers.erase(nodeId);
 }
 
 void CommandInterface::Vehicle::setLaneChangeMode(int mode)
 {
+    CommandScope scope(cifc, __func__);
     uint8_t variableId = VAR_LANECHANGE_MODE;
     uint8_t type = TYPE_INTEGER;
-    TraCIBuffer buf = cifc->connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << type << mode);
-    ASSERT(buf.eof());
+    cifc->sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << type << mode);
 }
 
 void CommandInterface::Vehicle::getLaneChangeState(int direction, int& state1, int& state2)
 {
-    TraCIBuffer response = cifc->connection->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_CHANGELANE) << nodeId << static_cast<uint8_t>(TYPE_INTEGER) << direction);
+    CommandScope scope(cifc, __func__);
+    TraCIBuffer response = cifc->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(CMD_CHANGELANE) << nodeId << static_cast<uint8_t>(TYPE_INTEGER) << direction);
     uint8_t cmdLength;
     response >> cmdLength;
     uint8_t responseId;
@@ -75,21 +627,23 @@ void CommandInterface::Vehicle::getLaneChangeState(int direction, int& state1, i
 
 void CommandInterface::Vehicle::changeLane(int lane, double duration)
 {
+    CommandScope scope(cifc, __func__);
     performPlatoonLaneChange(lane);
 }
 
 void CommandInterface::Vehicle::changeLaneRelative(int lane, double duration)
 {
+    CommandScope scope(cifc, __func__);
     uint8_t commandType = TYPE_COMPOUND;
     int nParameters = 3;
     uint8_t variableId = CMD_CHANGELANE;
-    TraCIBuffer buf = cifc->connection->query(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << commandType << nParameters << static_cast<uint8_t>(TYPE_BYTE) << (uint8_t) lane << static_cast<uint8_t>(TYPE_DOUBLE) << duration << static_cast<uint8_t>(TYPE_BYTE) << (uint8_t) 1);
-    ASSERT(buf.eof());
+    cifc->sendCommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer() << variableId << nodeId << commandType << nParameters << static_cast<uint8_t>(TYPE_BYTE) << (uint8_t) lane << static_cast<uint8_t>(TYPE_DOUBLE) << duration << static_cast<uint8_t>(TYPE_BYTE) << (uint8_t) 1);
 }
 
 std::vector<CommandInterface::Vehicle::neighbor> CommandInterface::Vehicle::getNeighbors(uint8_t lateralDirection, uint8_t longitudinalDirection, uint8_t blocking)
 {
-    TraCIBuffer response = cifc->connection->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_NEIGHBORS)
+    CommandScope scope(cifc, __func__);
+    TraCIBuffer response = cifc->query(CMD_GET_VEHICLE_VARIABLE, TraCIBuffer() << static_cast<uint8_t>(VAR_NEIGHBORS)
         << nodeId
         << static_cast<uint8_t>(TYPE_UBYTE)
         << static_cast<uint8_t>(blocking<<2 | longitudinalDirection<<1 | lateralDirection));
@@ -126,119 +680,172 @@ std::vector<CommandInterface::Vehicle::neighbor> CommandInterface::Vehicle::getN
 
 void CommandInterface::Vehicle::setLeaderVehicleData(double controllerAcceleration, double acceleration, double speed, double positionX, double positionY, double time)
 {
-    ParBuffer buf;
-    buf << speed << acceleration << positionX << positionY << time << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_LEADER_SPEED_AND_ACCELERATION, buf.str());
+    CommandScope scope(cifc, __func__);
+    if (cifc->fastParameterEncoding) cifc->setParameter(nodeId, PAR_LEADER_SPEED_AND_ACCELERATION, encodeLeaderOrFrontData<FastParBuffer>(controllerAcceleration, acceleration, speed, positionX, positionY, time));
+    else cifc->setParameter(nodeId, PAR_LEADER_SPEED_AND_ACCELERATION, encodeLeaderOrFrontData<ParBuffer>(controllerAcceleration, acceleration, speed, positionX, positionY, time));
 }
 
 void CommandInterface::Vehicle::setPlatoonLeaderData(double speed, double acceleration, double positionX, double positionY, double time)
 {
+    CommandScope scope(cifc, __func__);
     std::cout << "setPlatoonLeaderData() is deprecated and will be removed. Please use setLeaderVehicleData()\n";
     setLeaderVehicleData(acceleration, acceleration, speed, positionX, positionY, time);
 }
 
 void CommandInterface::Vehicle::setFrontVehicleData(double controllerAcceleration, double acceleration, double speed, double positionX, double positionY, double time)
 {
-    ParBuffer buf;
-    buf << speed << acceleration << positionX << positionY << time << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_PRECEDING_SPEED_AND_ACCELERATION, buf.str());
+    CommandScope scope(cifc, __func__);
+    if (cifc->fastParameterEncoding) cifc->setParameter(nodeId, PAR_PRECEDING_SPEED_AND_ACCELERATION, encodeLeaderOrFrontData<FastParBuffer>(controllerAcceleration, acceleration, speed, positionX, positionY, time));
+    else cifc->setParameter(nodeId, PAR_PRECEDING_SPEED_AND_ACCELERATION, encodeLeaderOrFrontData<ParBuffer>(controllerAcceleration, acceleration, speed, positionX, positionY, time));
 }
 
 void CommandInterface::Vehicle::getVehicleData(double& speed, double& acceleration, double& controllerAcceleration, double& positionX, double& positionY, double& time)
 {
+    CommandScope scope(cifc, __func__);
+    if (cifc->useSubscriptions) {
+        if (const Subscription* subscription = cifc->getSubscription(nodeId)) {
+            const VEHICLE_DATA& data = subscription->vehicleData;
+            speed = data.speed;
+            acceleration = data.acceleration;
+            controllerAcceleration = data.u;
+            positionX = data.positionX;
+            positionY = data.positionY;
+            time = data.time;
+            return;
+        }
+    }
     std::string v;
-    veinsVehicle().getParameter(PAR_SPEED_AND_ACCELERATION, v);
-    ParBuffer buf(v);
-    buf >> speed >> acceleration >> controllerAcceleration >> positionX >> positionY >> time;
+    cifc->getParameter(nodeId, PAR_SPEED_AND_ACCELERATION, v);
+    VEHICLE_DATA data;
+    if (cifc->fastParameterEncoding) decodeVehicleData<FastParBuffer>(v, &data);
+    else decodeVehicleData<ParBuffer>(v, &data);
+    speed = data.speed;
+    acceleration = data.acceleration;
+    controllerAcceleration = data.u;
+    positionX = data.positionX;
+    positionY = data.positionY;
+    time = data.time;
 }
 
 void CommandInterface::Vehicle::getVehicleData(VEHICLE_DATA* data)
 {
+    CommandScope scope(cifc, __func__);
+    if (cifc->useSubscriptions) {
+        if (const Subscription* subscription = cifc->getSubscription(nodeId)) {
+            const VEHICLE_DATA& stored = subscription->vehicleData;
+            data->speed = stored.speed;
+            data->acceleration = stored.acceleration;
+            data->u = stored.u;
+            data->positionX = stored.positionX;
+            data->positionY = stored.positionY;
+            data->time = stored.time;
+            data->speedX = stored.speedX;
+            data->speedY = stored.speedY;
+            data->angle = stored.angle;
+            return;
+        }
+    }
     std::string v;
-    veinsVehicle().getParameter(PAR_SPEED_AND_ACCELERATION, v);
-    ParBuffer buf(v);
-    buf >> data->speed >> data->acceleration >> data->u >> data->positionX >> data->positionY >> data->time >> data->speedX >> data->speedY >> data->angle;
+    cifc->getParameter(nodeId, PAR_SPEED_AND_ACCELERATION, v);
+    if (cifc->fastParameterEncoding) decodeVehicleData<FastParBuffer>(v, data);
+    else decodeVehicleData<ParBuffer>(v, data);
 }
 
 void CommandInterface::Vehicle::setCruiseControlDesiredSpeed(double desiredSpeed)
 {
-    veinsVehicle().setParameter(PAR_CC_DESIRED_SPEED, desiredSpeed);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_CC_DESIRED_SPEED, desiredSpeed);
 }
 
 const double CommandInterface::Vehicle::getCruiseControlDesiredSpeed()
 {
+    CommandScope scope(cifc, __func__);
     double desiredSpeed;
-    veinsVehicle().getParameter(PAR_CC_DESIRED_SPEED, desiredSpeed);
+    cifc->getParameter(nodeId, PAR_CC_DESIRED_SPEED, desiredSpeed);
     return desiredSpeed;
 }
 
 void CommandInterface::Vehicle::setActiveController(int activeController)
 {
-    veinsVehicle().setParameter(PAR_ACTIVE_CONTROLLER, activeController);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_ACTIVE_CONTROLLER, activeController);
 }
 
 int CommandInterface::Vehicle::getActiveController()
 {
+    CommandScope scope(cifc, __func__);
     int v;
-    veinsVehicle().getParameter(PAR_ACTIVE_CONTROLLER, v);
+    cifc->getParameter(nodeId, PAR_ACTIVE_CONTROLLER, v);
     return v;
 }
 
 void CommandInterface::Vehicle::setCACCConstantSpacing(double spacing)
 {
-    veinsVehicle().setParameter(PAR_CACC_SPACING, spacing);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_CACC_SPACING, spacing);
 }
 
 double CommandInterface::Vehicle::getCACCConstantSpacing()
 {
+    CommandScope scope(cifc, __func__);
     double v;
-    veinsVehicle().getParameter(PAR_CACC_SPACING, v);
+    cifc->getParameter(nodeId, PAR_CACC_SPACING, v);
     return v;
 }
 
 void CommandInterface::Vehicle::setPathCACCParameters(double omegaN, double xi, double c1, double distance)
 {
-    if (omegaN >= 0) veinsVehicle().setParameter(CC_PAR_CACC_OMEGA_N, omegaN);
-    if (xi >= 0) veinsVehicle().setParameter(CC_PAR_CACC_XI, xi);
-    if (c1 >= 0) veinsVehicle().setParameter(CC_PAR_CACC_C1, c1);
-    if (distance >= 0) veinsVehicle().setParameter(PAR_CACC_SPACING, distance);
+    CommandScope scope(cifc, __func__);
+    if (omegaN >= 0) cifc->setParameter(nodeId, CC_PAR_CACC_OMEGA_N, omegaN);
+    if (xi >= 0) cifc->setParameter(nodeId, CC_PAR_CACC_XI, xi);
+    if (c1 >= 0) cifc->setParameter(nodeId, CC_PAR_CACC_C1, c1);
+    if (distance >= 0) cifc->setParameter(nodeId, PAR_CACC_SPACING, distance);
 }
 
 void CommandInterface::Vehicle::setPloegCACCParameters(double kp, double kd, double h)
 {
-    if (kp >= 0) veinsVehicle().setParameter(CC_PAR_PLOEG_KP, kp);
-    if (kd >= 0) veinsVehicle().setParameter(CC_PAR_PLOEG_KD, kd);
-    if (h >= 0) veinsVehicle().setParameter(CC_PAR_PLOEG_H, h);
+    CommandScope scope(cifc, __func__);
+    if (kp >= 0) cifc->setParameter(nodeId, CC_PAR_PLOEG_KP, kp);
+    if (kd >= 0) cifc->setParameter(nodeId, CC_PAR_PLOEG_KD, kd);
+    if (h >= 0) cifc->setParameter(nodeId, CC_PAR_PLOEG_H, h);
 }
 
 void CommandInterface::Vehicle::setACCHeadwayTime(double headway)
 {
-    veinsVehicle().setParameter(PAR_ACC_HEADWAY_TIME, headway);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_ACC_HEADWAY_TIME, headway);
 }
 
 double CommandInterface::Vehicle::getACCHeadwayTime()
 {
+    CommandScope scope(cifc, __func__);
     double headway;
-    veinsVehicle().getParameter(PAR_ACC_HEADWAY_TIME, headway);
+    cifc->getParameter(nodeId, PAR_ACC_HEADWAY_TIME, headway);
     return headway;
 }
 
 void CommandInterface::Vehicle::setFixedAcceleration(int activate, double acceleration)
 {
+    CommandScope scope(cifc, __func__);
     ParBuffer buf;
     buf << activate << acceleration;
-    veinsVehicle().setParameter(PAR_FIXED_ACCELERATION, buf.str());
+    cifc->setParameter(nodeId, PAR_FIXED_ACCELERATION, buf.str());
 }
 
 bool CommandInterface::Vehicle::isCrashed()
 {
+    CommandScope scope(cifc, __func__);
+    if (cifc->useSubscriptions) {
+        if (const Subscription* subscription = cifc->getSubscription(nodeId)) return subscription->crashed;
+    }
     int crashed;
-    veinsVehicle().getParameter(PAR_CRASHED, crashed);
+    cifc->getParameter(nodeId, PAR_CRASHED, crashed);
     return crashed;
 }
 
 void CommandInterface::Vehicle::setFixedLane(int8_t laneIndex, bool safe)
 {
+    CommandScope scope(cifc, __func__);
 
     if (laneIndex == -1) {
         // give back total control to sumo (e.g., when using human driven vehicles)
@@ -252,139 +859,238 @@ void CommandInterface::Vehicle::setFixedLane(int8_t laneIndex, bool safe)
 
 void CommandInterface::Vehicle::getRadarMeasurements(double& distance, double& relativeSpeed)
 {
+    CommandScope scope(cifc, __func__);
+    if (cifc->useSubscriptions) {
+        if (const Subscription* subscription = cifc->getSubscription(nodeId)) {
+            distance = subscription->radarDistance;
+            relativeSpeed = subscription->radarRelativeSpeed;
+            return;
+        }
+    }
     std::string v;
-    veinsVehicle().getParameter(PAR_RADAR_DATA, v);
+    cifc->getParameter(nodeId, PAR_RADAR_DATA, v);
     ParBuffer buf(v);
     buf >> distance >> relativeSpeed;
 }
 
 void CommandInterface::Vehicle::setLeaderVehicleFakeData(double controllerAcceleration, double acceleration, double speed)
 {
+    CommandScope scope(cifc, __func__);
     ParBuffer buf;
     buf << speed << acceleration << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_LEADER_FAKE_DATA, buf.str());
+    cifc->setParameter(nodeId, PAR_LEADER_FAKE_DATA, buf.str());
 }
 
 void CommandInterface::Vehicle::setLeaderFakeData(double leaderSpeed, double leaderAcceleration)
 {
+    CommandScope scope(cifc, __func__);
     std::cout << "setLeaderFakeData() is deprecated and will be removed. Please use setLeaderVehicleFakeData()\n";
     setLeaderVehicleFakeData(leaderAcceleration, leaderAcceleration, leaderSpeed);
 }
 
 void CommandInterface::Vehicle::setFrontVehicleFakeData(double controllerAcceleration, double acceleration, double speed, double distance)
 {
+    CommandScope scope(cifc, __func__);
     ParBuffer buf;
     buf << speed << acceleration << distance << controllerAcceleration;
-    veinsVehicle().setParameter(PAR_FRONT_FAKE_DATA, buf.str());
+    cifc->setParameter(nodeId, PAR_FRONT_FAKE_DATA, buf.str());
 }
 
 void CommandInterface::Vehicle::setPrecedingVehicleData(double speed, double acceleration, double positionX, double positionY, double time)
 {
+    CommandScope scope(cifc, __func__);
     std::cout << "setPrecedingVehicleData() is deprecated and will be removed. Please use setFrontVehicleData()\n";
     setFrontVehicleData(acceleration, acceleration, speed, positionX, positionY, time);
 }
 
 void CommandInterface::Vehicle::setFrontFakeData(double frontDistance, double frontSpeed, double frontAcceleration)
 {
+    CommandScope scope(cifc, __func__);
     std::cout << "setFrontFakeData() is deprecated and will be removed. Please use setFrontVehicleFakeData()\n";
     setFrontVehicleFakeData(frontAcceleration, frontAcceleration, frontSpeed, frontDistance);
 }
 
 double CommandInterface::Vehicle::getDistanceToRouteEnd()
 {
+    CommandScope scope(cifc, __func__);
     double v;
-    veinsVehicle().getParameter(PAR_DISTANCE_TO_END, v);
+    cifc->getParameter(nodeId, PAR_DISTANCE_TO_END, v);
     return v;
 }
 
 double CommandInterface::Vehicle::getDistanceFromRouteBegin()
 {
+    CommandScope scope(cifc, __func__);
     double v;
-    veinsVehicle().getParameter(PAR_DISTANCE_FROM_BEGIN, v);
+    cifc->getParameter(nodeId, PAR_DISTANCE_FROM_BEGIN, v);
     return v;
 }
 
 double CommandInterface::Vehicle::getACCAcceleration()
 {
+    CommandScope scope(cifc, __func__);
     double v;
-    veinsVehicle().getParameter(PAR_ACC_ACCELERATION, v);
+    cifc->getParameter(nodeId, PAR_ACC_ACCELERATION, v);
     return v;
 }
 
 void CommandInterface::Vehicle::setVehicleData(const struct VEHICLE_DATA* data)
 {
-    ParBuffer buf;
-    buf << data->index << data->speed << data->acceleration << data->positionX << data->positionY << data->time << data->length << data->u << data->speedX << data->speedY << data->angle;
-    veinsVehicle().setParameter(CC_PAR_VEHICLE_DATA, buf.str());
+    CommandScope scope(cifc, __func__);
+    if (cifc->fastParameterEncoding) cifc->setParameter(nodeId, CC_PAR_VEHICLE_DATA, encodeStoredVehicleData<FastParBuffer>(data));
+    else cifc->setParameter(nodeId, CC_PAR_VEHICLE_DATA, encodeStoredVehicleData<ParBuffer>(data));
+}
+
+void CommandInterface::Vehicle::setPlatoonVehicleData(const std::vector<VEHICLE_DATA>& data, const VEHICLE_DATA* leaderData, const VEHICLE_DATA* frontData)
+{
+    CommandScope scope(cifc, __func__);
+    // queue all commands and send them together, unless the caller is already batching
+    bool batching = cifc->batchCommands;
+    cifc->batchCommands = true;
+    if (leaderData) setLeaderVehicleData(leaderData->u, leaderData->acceleration, leaderData->speed, leaderData->positionX, leaderData->positionY, leaderData->time);
+    if (frontData) setFrontVehicleData(frontData->u, frontData->acceleration, frontData->speed, frontData->positionX, frontData->positionY, frontData->time);
+    for (const auto& vehicleData : data) setVehicleData(&vehicleData);
+    if (!batching) {
+        cifc->flushCommands();
+        cifc->batchCommands = false;
+    }
 }
 
 void CommandInterface::Vehicle::getStoredVehicleData(struct VEHICLE_DATA* data, int index)
 {
-    ParBuffer inBuf;
+    CommandScope scope(cifc, __func__);
     std::string v;
-    inBuf << CC_PAR_VEHICLE_DATA << index;
-    veinsVehicle().getParameter(inBuf.str(), v);
-    ParBuffer outBuf(v);
-    outBuf >> data->index >> data->speed >> data->acceleration >> data->positionX >> data->positionY >> data->time >> data->length >> data->u >> data->speedX >> data->speedY >> data->angle;
+    if (cifc->fastParameterEncoding) {
+        FastParBuffer inBuf;
+        inBuf << CC_PAR_VEHICLE_DATA << index;
+        cifc->getParameter(nodeId, inBuf.str(), v);
+        decodeStoredVehicleData<FastParBuffer>(v, data);
+    }
+    else {
+        ParBuffer inBuf;
+        inBuf << CC_PAR_VEHICLE_DATA << index;
+        cifc->getParameter(nodeId, inBuf.str(), v);
+        decodeStoredVehicleData<ParBuffer>(v, data);
+    }
 }
 
 void CommandInterface::Vehicle::useControllerAcceleration(bool use)
 {
-    veinsVehicle().setParameter(PAR_USE_CONTROLLER_ACCELERATION, use ? 1 : 0);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_USE_CONTROLLER_ACCELERATION, use ? 1 : 0);
 }
 
 void CommandInterface::Vehicle::getEngineData(int& gear, double& rpm)
 {
+    CommandScope scope(cifc, __func__);
     ParBuffer inBuf;
     std::string v;
     inBuf << PAR_ENGINE_DATA;
-    veinsVehicle().getParameter(inBuf.str(), v);
+    cifc->getParameter(nodeId, inBuf.str(), v);
     ParBuffer outBuf(v);
     outBuf >> gear >> rpm;
 }
 
 void CommandInterface::Vehicle::enableAutoFeed(bool enable, std::string leaderId, std::string frontId)
 {
+    CommandScope scope(cifc, __func__);
     if (enable && (leaderId.compare("") == 0 || frontId.compare("") == 0)) return;
     ParBuffer inBuf;
     if (enable)
         inBuf << 1 << leaderId << frontId;
     else
         inBuf << 0;
-    veinsVehicle().setParameter(PAR_USE_AUTO_FEEDING, inBuf.str());
+    cifc->setParameter(nodeId, PAR_USE_AUTO_FEEDING, inBuf.str());
 }
 
 void CommandInterface::Vehicle::usePrediction(bool enable)
 {
-    veinsVehicle().setParameter(PAR_USE_PREDICTION, enable ? 1 : 0);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_USE_PREDICTION, enable ? 1 : 0);
 }
 
 void CommandInterface::Vehicle::addPlatoonMember(std::string memberId, int position)
 {
+    CommandScope scope(cifc, __func__);
     ParBuffer inBuf;
     inBuf << memberId << position;
-    veinsVehicle().setParameter(PAR_ADD_MEMBER, inBuf.str());
+    cifc->setParameter(nodeId, PAR_ADD_MEMBER, inBuf.str());
+    cifc->platoonMembers[nodeId][memberId] = position;
 }
 
 void CommandInterface::Vehicle::removePlatoonMember(std::string memberId)
 {
-    veinsVehicle().setParameter(PAR_REMOVE_MEMBER, memberId);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_REMOVE_MEMBER, memberId);
+    auto known = cifc->platoonMembers.find(nodeId);
+    if (known == cifc->platoonMembers.end()) return;
+    known->second.erase(memberId);
+    // do not keep an entry for each vehicle that has ever led a platoon
+    if (known->second.empty()) cifc->platoonMembers.erase(known);
+}
+
+void CommandInterface::Vehicle::setPlatoonMembers(const std::vector<std::string>& members)
+{
+    CommandScope scope(cifc, __func__);
+    std::map<std::string, int> current;
+    auto known = cifc->platoonMembers.find(nodeId);
+    if (known != cifc->platoonMembers.end()) current = known->second;
+    // queue all commands and send them together, unless the caller is already batching
+    bool batching = cifc->batchCommands;
+    cifc->batchCommands = true;
+    for (const auto& member : current) {
+        if (std::find(members.begin(), members.end(), member.first) == members.end()) removePlatoonMember(member.first);
+    }
+    for (size_t i = 0; i < members.size(); i++) {
+        int position = i + 1;
+        auto member = current.find(members[i]);
+        if (member == current.end() || member->second != position) addPlatoonMember(members[i], position);
+    }
+    if (!batching) {
+        cifc->flushCommands();
+        cifc->batchCommands = false;
+    }
 }
 
 void CommandInterface::Vehicle::enableAutoLaneChanging(bool enable)
 {
-    veinsVehicle().setParameter(PAR_ENABLE_AUTO_LANE_CHANGE, enable ? 1 : 0);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_ENABLE_AUTO_LANE_CHANGE, enable ? 1 : 0);
 }
 
 void CommandInterface::Vehicle::performPlatoonLaneChange(int lane)
 {
-    veinsVehicle().setParameter(PAR_PLATOON_FIXED_LANE, lane);
+    CommandScope scope(cifc, __func__);
+    cifc->setParameter(nodeId, PAR_PLATOON_FIXED_LANE, lane);
+}
+
+void CommandInterface::Vehicle::applyControllerProfile(const std::string& name)
+{
+    CommandScope scope(cifc, __func__);
+    auto registered = cifc->controllerProfiles.find(name);
+    if (registered == cifc->controllerProfiles.end()) throw cRuntimeError("Unknown controller profile \"%s\"", name.c_str());
+    const RegisteredProfile& entry = registered->second;
+
+    // only the vehicle id differs from one vehicle to another
+    std::string header = (TraCIBuffer() << static_cast<uint8_t>(VAR_PARAMETER) << nodeId).str();
+    for (const auto& parameter : entry.encodedParameters) {
+        cifc->pendingCommands += veins::makeTraCICommand(CMD_SET_VEHICLE_VARIABLE, TraCIBuffer(header + parameter));
+        cifc->nPendingCommands++;
+    }
+    if (cifc->shadowParameters) {
+        for (const auto& parameter : entry.profile) {
+            if (isShadowedParameter(parameter.first)) cifc->shadowValues[nodeId][parameter.first] = parameter.second;
+        }
+    }
+    // send all commands together, unless the caller is already batching
+    if (!cifc->batchCommands) cifc->flushCommands();
 }
 
 unsigned int CommandInterface::Vehicle::getLanesCount()
 {
+    CommandScope scope(cifc, __func__);
     int v;
-    veinsVehicle().getParameter(PAR_LANES_COUNT, v);
+    cifc->getParameter(nodeId, PAR_LANES_COUNT, v);
     return (unsigned int) v;
 }
 
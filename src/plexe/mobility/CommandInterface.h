@@ -22,11 +22,15 @@
 
 #include "plexe/plexe.h"
 #include "plexe/CC_Const.h"
+#include "plexe/mobility/InsertionEngine.h"
 
 #include <veins/modules/utility/HasLogProxy.h>
 #include <veins/modules/mobility/traci/TraCICommandInterface.h>
+#include <veins/modules/mobility/traci/TraCIBuffer.h>
 
+#include <chrono>
 #include <map>
+#include <vector>
 
 namespace veins {
 class TraCIConnection;
@@ -215,6 +219,20 @@ public:
          */
         void setVehicleData(const struct plexe::VEHICLE_DATA* data);
 
+        /**
+         * Sets data information about several vehicles in the same platoon,
+         * and optionally about the leader and the front vehicle, sending all
+         * the commands to SUMO within a single TraCI message. This is
+         * equivalent to calling setLeaderVehicleData(), setFrontVehicleData(),
+         * and setVehicleData() for each element, but avoids one round trip per
+         * call. If batching is enabled, the commands are appended to the
+         * pending ones instead
+         * @param data: data of the platoon members
+         * @param leaderData: data of the leader, or nullptr to leave it untouched
+         * @param frontData: data of the front vehicle, or nullptr to leave it untouched
+         */
+        void setPlatoonVehicleData(const std::vector<plexe::VEHICLE_DATA>& data, const struct plexe::VEHICLE_DATA* leaderData = nullptr, const struct plexe::VEHICLE_DATA* frontData = nullptr);
+
         /**
          * Gets data information about a vehicle in the same platoon, as stored by this car
          */
@@ -272,6 +290,17 @@ public:
          */
         void removePlatoonMember(std::string memberId);
 
+        /**
+         * Sets the platoon members of this vehicle, usually considered to be
+         * the leader. Only the differences with respect to the members set
+         * by previous calls, addPlatoonMember(), and removePlatoonMember()
+         * are sent to SUMO, within a single TraCI message. If batching is
+         * enabled, the commands are appended to the pending ones instead
+         * @param members: sumo ids of the members, where the i-th element is
+         * the member at position i + 1 (i.e., the leader is not included)
+         */
+        void setPlatoonMembers(const std::vector<std::string>& members);
+
         /**
          * Enables/disables automatic, coordinated, whole-platoon lane changes.
          * This function should be invoked on the leader which decides whether
@@ -297,6 +326,15 @@ public:
          */
         unsigned int getLanesCount();
 
+        /**
+         * Sets all the parameters of a controller profile registered with
+         * registerControllerProfile(), sending them to SUMO within a single
+         * TraCI message. If batching is enabled, the commands are appended to
+         * the pending ones instead
+         * @param name: name of the profile
+         */
+        void applyControllerProfile(const std::string& name);
+
         veins::TraCICommandInterface::Vehicle veinsVehicle()
         {
             return {cifc->veinsCommandInterface, nodeId};
@@ -308,6 +346,45 @@ public:
         const std::string nodeId;
     };
 
+    /**
+     * Statistics about the messages used to send batched set commands
+     */
+    struct BatchStatistics {
+        // number of messages sent to flush the pending commands
+        long flushes = 0;
+        // total number of commands sent through batching
+        long commands = 0;
+        // maximum number of commands sent within a single message
+        long maxCommandsPerFlush = 0;
+    };
+
+    /**
+     * Statistics about reads of shadowed controller parameters
+     */
+    struct ShadowStatistics {
+        // reads answered locally
+        long hits = 0;
+        // reads forwarded to SUMO because the value was never set by Plexe
+        long misses = 0;
+        // local answers cross-checked against SUMO
+        long verifications = 0;
+        // cross-checks in which SUMO reported a different value
+        long mismatches = 0;
+    };
+
+    /**
+     * Statistics about the calls to one Plexe command
+     */
+    struct CommandStatistics {
+        long calls = 0;
+        // bytes of TraCI commands sent to SUMO on behalf of this command
+        long bytesSent = 0;
+        // bytes of TraCI responses received for this command
+        long bytesReceived = 0;
+        // wall clock time spent per call, in seconds
+        cHistogram latency;
+    };
+
     CommandInterface(cComponent* owner, veins::TraCICommandInterface* commandInterface, veins::TraCIConnection* connection);
 
     Vehicle vehicle(const std::string& nodeId)
@@ -315,9 +392,353 @@ public:
         return {this, nodeId};
     }
 
+    /**
+     * Enables or disables batching of set commands. When enabled, set
+     * commands are not sent immediately but appended to a buffer of
+     * pending commands, which is sent to SUMO as a single TraCI message
+     * by flushCommands(). Pending commands are flushed automatically
+     * before any get command, so reads always see previous writes
+     * @param batch: enable or disable batching. Disabling batching
+     * flushes pending commands
+     */
+    void setBatchCommands(bool batch);
+
+    /**
+     * Returns whether set commands are being batched
+     */
+    bool isBatchingCommands() const
+    {
+        return batchCommands;
+    }
+
+    /**
+     * Sends all pending set commands to SUMO within a single TraCI message.
+     * This must be invoked before SUMO performs a simulation step, which
+     * is done by the PlexeManager at the beginning of each time step
+     */
+    void flushCommands();
+
+    /**
+     * Returns statistics about batched commands
+     */
+    const BatchStatistics& getBatchStatistics() const
+    {
+        return batchStatistics;
+    }
+
+    /**
+     * Enables or disables subscriptions to vehicle data. When enabled, the
+     * first call to getVehicleData(), getRadarMeasurements(), or isCrashed()
+     * for a vehicle subscribes it. In each time step, the data of all
+     * subscribed vehicles is then fetched with a single TraCI message and
+     * following calls are served from memory
+     * @param use: enable or disable subscriptions
+     */
+    void setUseSubscriptions(bool use);
+
+    /**
+     * Returns whether vehicle data is obtained through subscriptions
+     */
+    bool isUsingSubscriptions() const
+    {
+        return useSubscriptions;
+    }
+
+    /**
+     * Subscribes the given vehicles, if needed, and fetches the data of all
+     * subscribed vehicles with outdated data with a single TraCI message.
+     * Following calls to getVehicleData(), getRadarMeasurements(), and
+     * isCrashed() for these vehicles are served from memory. Has no effect
+     * if subscriptions are disabled
+     * @param nodeIds: sumo ids of the vehicles
+     */
+    void prefetchSubscriptions(const std::vector<std::string>& nodeIds);
+
+    /**
+     * Marks the data of subscribed vehicles as outdated. This must be
+     * invoked after SUMO performs a simulation step, which is done by the
+     * PlexeManager at the end of each time step
+     */
+    void invalidateSubscriptions();
+
+    /**
+     * Enables or disables the local shadow copy of controller parameters.
+     * When enabled, the values written by setCruiseControlDesiredSpeed(),
+     * setActiveController(), setACCHeadwayTime(), and
+     * setCACCConstantSpacing() are stored locally and the matching getters
+     * are answered without contacting SUMO
+     * @param shadow: enable or disable the shadow copy
+     * @param verificationInterval: if greater than 0, one every
+     * verificationInterval local answers is cross-checked against SUMO. On
+     * mismatch, a warning is logged and the value from SUMO is used
+     */
+    void setShadowParameters(bool shadow, int verificationInterval = 0);
+
+    /**
+     * Returns whether controller parameters are answered locally
+     */
+    bool isShadowingParameters() const
+    {
+        return shadowParameters;
+    }
+
+    /**
+     * Drops the shadow copy of the parameters of a vehicle and the platoon
+     * members it leads. Must be invoked when the vehicle leaves the
+     * simulation
+     * @param nodeId: sumo id of the vehicle
+     */
+    void forgetVehicle(const std::string& nodeId);
+
+    /**
+     * Returns statistics about shadowed controller parameters
+     */
+    const ShadowStatistics& getShadowStatistics() const
+    {
+        return shadowStatistics;
+    }
+
+    /**
+     * Selects how vehicle data (leader, front, platoon members, and own data)
+     * is formatted and parsed. The fast encoding uses FastParBuffer instead of
+     * veins::ParBuffer. Both produce the same strings, so SUMO is unaffected
+     * @param fast: use the fast encoding
+     */
+    void setFastParameterEncoding(bool fast)
+    {
+        fastParameterEncoding = fast;
+    }
+
+    /**
+     * Returns whether vehicle data is encoded with FastParBuffer
+     */
+    bool isUsingFastParameterEncoding() const
+    {
+        return fastParameterEncoding;
+    }
+
+    /**
+     * Enables or disables per-command instrumentation. When enabled, each
+     * command (e.g., setVehicleData or changeLaneRelative) counts its calls,
+     * the bytes exchanged with SUMO, and its wall clock latency. Commands
+     * invoked by other commands are accounted to the outermost one. Flushes
+     * of batched commands and subscription updates not triggered by a
+     * command are accounted as flushCommands and updateSubscriptions
+     */
+    void setInstrumentCommands(bool instrument);
+
+    /**
+     * Returns whether commands are instrumented
+     */
+    bool isInstrumentingCommands() const
+    {
+        return instrumentCommands;
+    }
+
+    /**
+     * Returns the statistics of instrumented commands, indexed by command name
+     */
+    const std::map<std::string, CommandStatistics>& getCommandStatistics() const
+    {
+        return commandStatistics;
+    }
+    std::map<std::string, CommandStatistics>& getCommandStatistics()
+    {
+        return commandStatistics;
+    }
+
+    /**
+     * Inserts a batch of vehicles into SUMO with a single TraCI message.
+     * Pending set commands are sent within the same message. Vehicles are
+     * inserted at the current time step; a lane of -1 selects the first
+     * allowed lane, negative positions and speeds select SUMO's "base" and
+     * "max" values. Can be used as the inserter of an InsertionEngine
+     * @param insertions: the vehicles to insert
+     * @param success: filled with whether each vehicle has been inserted
+     */
+    void addVehicles(const std::vector<InsertionEngine::Insertion>& insertions, std::vector<bool>& success);
+
+    /**
+     * Removes a batch of vehicles inserted with addVehicles() in the current
+     * time step with a single TraCI message. Can be used as the remover of
+     * an InsertionEngine
+     * @param insertions: the vehicles to remove
+     */
+    void removeVehicles(const std::vector<InsertionEngine::Insertion>& insertions);
+
+    /**
+     * Parameters shared by several vehicles (e.g., the gains of their
+     * controllers) as pairs of parameter name and value, in the order in
+     * which they must be set
+     */
+    typedef std::vector<std::pair<std::string, std::string>> ControllerProfile;
+
+    /**
+     * Registers a named controller profile. The set commands of the profile
+     * are serialized once, and Vehicle::applyControllerProfile() only adds
+     * the vehicle id to them. Registering a name again with the same
+     * parameters has no effect, while registering it with different ones
+     * is an error
+     * @param name: name of the profile
+     * @param profile: parameters of the profile
+     */
+    void registerControllerProfile(const std::string& name, const ControllerProfile& profile);
+
+    /**
+     * Returns whether a controller profile with the given name is registered
+     */
+    bool hasControllerProfile(const std::string& name) const
+    {
+        return controllerProfiles.find(name) != controllerProfiles.end();
+    }
+
+    /**
+     * Returns the ids of the vehicles that SUMO detected as involved in a
+     * collision (either as collider or as victim) in the last simulation step
+     */
+    std::vector<std::string> getCollidingVehicles();
+
+    /**
+     * Asks SUMO to save the state of the simulation into a file. Relative
+     * paths refer to the working directory of SUMO
+     */
+    void saveState(const std::string& fileName);
+
+    /**
+     * Asks SUMO to replace the state of the simulation with the one saved
+     * into a file, including the simulation time
+     */
+    void loadState(const std::string& fileName);
+
 private:
+    /**
+     * Accounts the execution of a command to its statistics, from
+     * construction to destruction
+     */
+    class CommandScope {
+    public:
+        CommandScope(CommandInterface* cifc, const char* command);
+        ~CommandScope();
+
+    private:
+        CommandInterface* cifc;
+        // statistics of the command, nullptr if the scope is not accounted
+        CommandStatistics* statistics;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * Adds exchanged bytes to the statistics of the running command
+     */
+    void countTraffic(size_t sent, size_t received);
+
+    /**
+     * Data of a subscribed vehicle
+     */
+    struct Subscription {
+        // whether the data refers to the current time step
+        bool valid = false;
+        // whether SUMO provided the data in the current time step
+        bool available = false;
+        VEHICLE_DATA vehicleData;
+        double radarDistance = 0;
+        double radarRelativeSpeed = 0;
+        bool crashed = false;
+    };
+
+    /**
+     * Returns the up-to-date data of a subscribed vehicle, subscribing it
+     * if needed, or nullptr if SUMO could not provide it
+     */
+    const Subscription* getSubscription(const std::string& nodeId);
+
+    /**
+     * Fetches the data of all subscribed vehicles with outdated data. Pending
+     * set commands are sent within the same message
+     */
+    void updateSubscriptions();
+
+    /**
+     * Reads the status responses of the pending set commands from a response
+     * message and clears them
+     */
+    void readPendingCommandsStatus(veins::TraCIBuffer& response);
+
+    /**
+     * Sends a set command which only expects a status response. If batching
+     * is enabled, the command is appended to the pending commands instead
+     */
+    void sendCommand(uint8_t commandId, const veins::TraCIBuffer& buf);
+
+    /**
+     * Sends a get command after flushing pending commands and returns the response
+     */
+    veins::TraCIBuffer query(uint8_t commandId, const veins::TraCIBuffer& buf);
+
+    void setParameter(const std::string& nodeId, const std::string& parameter, const std::string& value);
+    void setParameter(const std::string& nodeId, const std::string& parameter, int value);
+    void setParameter(const std::string& nodeId, const std::string& parameter, double value);
+    void getParameter(const std::string& nodeId, const std::string& parameter, std::string& value);
+    void getParameter(const std::string& nodeId, const std::string& parameter, int& value);
+    void getParameter(const std::string& nodeId, const std::string& parameter, double& value);
+
+    /**
+     * Reads a parameter from SUMO, bypassing the shadow copy
+     */
+    void fetchParameter(const std::string& nodeId, const std::string& parameter, std::string& value);
+
+    /**
+     * Returns whether a parameter is part of the shadow copy
+     */
+    static bool isShadowedParameter(const std::string& parameter);
+
     veins::TraCICommandInterface* veinsCommandInterface;
     veins::TraCIConnection* connection;
+
+    // whether set commands are batched or sent immediately
+    bool batchCommands;
+    // set commands waiting to be sent, already serialized as TraCI commands
+    std::string pendingCommands;
+    // number of commands in pendingCommands
+    int nPendingCommands;
+    BatchStatistics batchStatistics;
+
+    // whether vehicle data is obtained through subscriptions
+    bool useSubscriptions;
+    // data of subscribed vehicles, indexed by SUMO id
+    std::map<std::string, Subscription> subscriptions;
+
+    // whether controller parameters are answered locally
+    bool shadowParameters;
+    // number of local answers between two cross-checks with SUMO. 0 disables them
+    int shadowVerificationInterval;
+    // last value of shadowed parameters, indexed by SUMO id and parameter name
+    std::map<std::string, std::map<std::string, std::string>> shadowValues;
+    ShadowStatistics shadowStatistics;
+
+    /**
+     * A controller profile together with its serialized set commands
+     */
+    struct RegisteredProfile {
+        ControllerProfile profile;
+        // variable and vehicle id are missing, as they are prepended for each vehicle
+        std::vector<std::string> encodedParameters;
+    };
+    // registered controller profiles, indexed by name
+    std::map<std::string, RegisteredProfile> controllerProfiles;
+
+    // platoon members known by SUMO, indexed by the id of the vehicle they
+    // were added to and by their own id. values are their positions
+    std::map<std::string, std::map<std::string, int>> platoonMembers;
+
+    // whether vehicle data is encoded with FastParBuffer instead of veins::ParBuffer
+    bool fastParameterEncoding;
+
+    // whether commands are instrumented
+    bool instrumentCommands;
+    std::map<std::string, CommandStatistics> commandStatistics;
+    // statistics of the outermost command being executed, if instrumented
+    CommandStatistics* currentCommand;
 };
 
 } // namespace traci
@@ -0,0 +1,117 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "plexe/mobility/FastParBuffer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace plexe {
+namespace traci {
+
+FastParBuffer::FastParBuffer()
+    : outLength(0)
+    , in(nullptr)
+    , inEnd(nullptr)
+{
+}
+
+FastParBuffer::FastParBuffer(const std::string& buf)
+    : outLength(0)
+    , in(buf.c_str())
+    , inEnd(buf.c_str() + buf.size())
+{
+}
+
+size_t FastParBuffer::prepareWrite()
+{
+    // same as ParBuffer: no separator before the first value
+    if (outLength > 0) {
+        if (outLength >= BUFFER_SIZE - 1) throw cRuntimeError("FastParBuffer: values do not fit in %d bytes", (int) BUFFER_SIZE);
+        outBuffer[outLength++] = SEP;
+    }
+    return BUFFER_SIZE - outLength;
+}
+
+void FastParBuffer::checkWritten(long written, size_t left) const
+{
+    // snprintf() also needs room for the terminating null character
+    if (written < 0 || (size_t) written >= left) throw cRuntimeError("FastParBuffer: values do not fit in %d bytes", (int) BUFFER_SIZE);
+}
+
+FastParBuffer& FastParBuffer::operator<<(double v)
+{
+    size_t left = prepareWrite();
+    // %g matches the default formatting of std::stringstream used by ParBuffer
+    int written = snprintf(outBuffer + outLength, left, "%g", v);
+    checkWritten(written, left);
+    outLength += written;
+    return *this;
+}
+
+FastParBuffer& FastParBuffer::operator<<(int v)
+{
+    size_t left = prepareWrite();
+    int written = snprintf(outBuffer + outLength, left, "%d", v);
+    checkWritten(written, left);
+    outLength += written;
+    return *this;
+}
+
+FastParBuffer& FastParBuffer::operator<<(const std::string& v)
+{
+    size_t left = prepareWrite();
+    checkWritten(v.size(), left);
+    memcpy(outBuffer + outLength, v.data(), v.size());
+    outLength += v.size();
+    return *this;
+}
+
+void FastParBuffer::skipValue()
+{
+    const char* sep = static_cast<const char*>(memchr(in, SEP, inEnd - in));
+    in = sep ? sep + 1 : inEnd;
+}
+
+FastParBuffer& FastParBuffer::operator>>(double& v)
+{
+    // like ParBuffer, leave v untouched if there is nothing to parse
+    if (in == inEnd) return *this;
+    char* end;
+    double value = strtod(in, &end);
+    if (end != in) v = value;
+    skipValue();
+    return *this;
+}
+
+FastParBuffer& FastParBuffer::operator>>(int& v)
+{
+    if (in == inEnd) return *this;
+    char* end;
+    long value = strtol(in, &end, 10);
+    if (end != in) v = (int) value;
+    skipValue();
+    return *this;
+}
+
+} // namespace traci
+} // namespace plexe
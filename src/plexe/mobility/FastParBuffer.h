@@ -0,0 +1,90 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#pragma once
+
+#include "plexe/plexe.h"
+
+#include <cstddef>
+#include <string>
+
+namespace plexe {
+namespace traci {
+
+/**
+ * Drop-in replacement for veins::ParBuffer that avoids string streams and
+ * heap allocations. Values are formatted exactly like ParBuffer does (six
+ * significant digits, colon separated), so the produced strings are
+ * byte-identical and SUMO parses them the same way.
+ *
+ * Values are written into a fixed buffer of BUFFER_SIZE bytes, enough for
+ * vehicle data. Writing more throws a cRuntimeError.
+ *
+ * When reading, the buffer does not copy the input string, which must
+ * outlive the buffer.
+ */
+class FastParBuffer {
+public:
+    FastParBuffer();
+    explicit FastParBuffer(const std::string& buf);
+
+    FastParBuffer& operator<<(double v);
+    FastParBuffer& operator<<(int v);
+    FastParBuffer& operator<<(const std::string& v);
+
+    FastParBuffer& operator>>(double& v);
+    FastParBuffer& operator>>(int& v);
+
+    /**
+     * Returns the formatted values
+     */
+    std::string str() const
+    {
+        return std::string(outBuffer, outLength);
+    }
+
+private:
+    /**
+     * Appends the separator if needed and returns the space left in the output buffer
+     */
+    size_t prepareWrite();
+
+    /**
+     * Throws if a value of the given length does not fit in the space left
+     */
+    void checkWritten(long written, size_t left) const;
+
+    /**
+     * Moves the input cursor after the next separator
+     */
+    void skipValue();
+
+    static const char SEP = ':';
+    static const size_t BUFFER_SIZE = 512;
+
+    char outBuffer[BUFFER_SIZE];
+    size_t outLength;
+    const char* in;
+    const char* inEnd;
+};
+
+} // namespace traci
+} // namespace plexe
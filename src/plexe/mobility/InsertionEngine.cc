@@ -0,0 +1,201 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/mobility/InsertionEngine.h"
+
+#include <algorithm>
+
+namespace plexe {
+
+InsertionEngine::InsertionEngine(bool insertInOrder, int maxBackoff)
+    : insertInOrder(insertInOrder)
+    , maxBackoff(std::max(maxBackoff, 1))
+    , currentStep(0)
+{
+}
+
+void InsertionEngine::setScenario(const std::vector<std::string>& vehicleTypes, const std::vector<std::string>& routes, StartLanes startLanes)
+{
+    this->vehicleTypes = vehicleTypes;
+    this->routes = routes;
+    this->startLanes = startLanes;
+}
+
+void InsertionEngine::enqueue(int route, int vehicleType, int lane, double position, double speed, int vehicleId)
+{
+    ASSERT(route >= 0 && vehicleType >= 0);
+    // vehicles can be queued before the scenario is known
+    if (route >= (int) queues.size()) queues.resize(route + 1);
+    if (vehicleType >= (int) vehiclesCount.size()) vehiclesCount.resize(vehicleType + 1, 0);
+
+    // vehicles are numbered in the order they are queued, which is the order
+    // in which traffic managers fill the position helper
+    QueuedVehicle vehicle;
+    vehicle.number = vehicleId < 0 ? vehiclesCount[vehicleType] : vehicleId;
+    vehiclesCount[vehicleType]++;
+    vehicle.type = vehicleType;
+    vehicle.lane = lane;
+    vehicle.position = position;
+    vehicle.speed = speed;
+    vehicle.done = false;
+    vehicle.inserted = false;
+    queues[route].vehicles.push_back(vehicle);
+}
+
+void InsertionEngine::skip(int vehicleType)
+{
+    ASSERT(vehicleType >= 0);
+    if (vehicleType >= (int) vehiclesCount.size()) vehiclesCount.resize(vehicleType + 1, 0);
+    vehiclesCount[vehicleType]++;
+}
+
+size_t InsertionEngine::pending() const
+{
+    size_t count = 0;
+    for (const auto& queue : queues) count += queue.vehicles.size();
+    return count;
+}
+
+bool InsertionEngine::chooseLane(int route, QueuedVehicle& vehicle, int& lane)
+{
+    if (vehicle.lane != -1 || insertInOrder) {
+        lane = vehicle.lane;
+        return fullLanes.count(std::make_pair(route, lane)) == 0;
+    }
+    // the vehicle can go on any lane: take the first one which did not refuse a vehicle yet
+    size_t lanes = startLanes(route);
+    for (size_t l = 0; l < lanes; l++) {
+        if (fullLanes.count(std::make_pair(route, (int) l)) == 0) {
+            lane = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+int InsertionEngine::step(const Inserter& insert, const Remover& remove)
+{
+    ASSERT(queues.size() <= routes.size());
+    currentStep++;
+    fullLanes.clear();
+
+    for (auto& queue : queues) {
+        queue.stopped = queue.vehicles.empty() || queue.nextAttempt > currentStep;
+        queue.attempted = false;
+        queue.failed = false;
+        queue.next = 0;
+        for (auto& vehicle : queue.vehicles) vehicle.done = false;
+    }
+
+    std::vector<Insertion> insertions;
+    std::vector<Insertion> removals;
+    std::vector<std::pair<int, QueuedVehicle*>> attempted;
+    std::vector<bool> success;
+    int inserted = 0;
+
+    // each round sends one batch. vehicles with a given lane are attempted
+    // once per step, vehicles which can go on any lane are attempted again on
+    // the next lane after a failure, until there are no lanes left
+    while (true) {
+        insertions.clear();
+        attempted.clear();
+        for (int r = 0; r < (int) queues.size(); r++) {
+            RouteQueue& queue = queues[r];
+            if (queue.stopped) continue;
+            // skip the vehicles attempted in the previous rounds
+            while (queue.next < queue.vehicles.size() && queue.vehicles[queue.next].done) queue.next++;
+            for (size_t i = queue.next; i < queue.vehicles.size(); i++) {
+                QueuedVehicle& vehicle = queue.vehicles[i];
+                if (vehicle.done) continue;
+                int lane;
+                if (!chooseLane(r, vehicle, lane)) {
+                    // this would fail like the previous attempt on the same lane
+                    statistics.skipped++;
+                    vehicle.done = true;
+                    if (insertInOrder) {
+                        queue.stopped = true;
+                        break;
+                    }
+                    continue;
+                }
+                if (vehicle.lane != -1 || insertInOrder) vehicle.done = true;
+                // the id is built once, on the first attempt
+                if (vehicle.id.empty()) vehicle.id = vehicleTypes[vehicle.type] + "." + std::to_string(vehicle.number);
+                insertions.push_back({&vehicle.id, &vehicleTypes[vehicle.type], &routes[r], lane, vehicle.position, vehicle.speed});
+                attempted.emplace_back(r, &vehicle);
+            }
+        }
+        if (insertions.empty()) break;
+
+        success.clear();
+        insert(insertions, success);
+        ASSERT(success.size() == insertions.size());
+        statistics.batches++;
+        statistics.attempts += insertions.size();
+
+        // attempts are in queue order within each route, so when inserting in
+        // order a stopped route means that a vehicle ahead has been refused
+        removals.clear();
+        for (size_t i = 0; i < insertions.size(); i++) {
+            RouteQueue& queue = queues[attempted[i].first];
+            QueuedVehicle* vehicle = attempted[i].second;
+            queue.attempted = true;
+            if (success[i] && insertInOrder && queue.stopped) {
+                // it would be on the road ahead of the refused vehicle
+                removals.push_back(insertions[i]);
+            }
+            else if (success[i]) {
+                vehicle->inserted = true;
+                vehicle->done = true;
+                inserted++;
+            }
+            else {
+                statistics.failures++;
+                fullLanes.insert(std::make_pair(attempted[i].first, insertions[i].lane));
+                queue.failed = true;
+                if (insertInOrder) queue.stopped = true;
+            }
+        }
+        if (!removals.empty()) {
+            remove(removals);
+            statistics.removals += removals.size();
+        }
+    }
+
+    bool attempts = false;
+    for (auto& queue : queues) {
+        if (!queue.attempted) continue;
+        attempts = true;
+        auto end = std::remove_if(queue.vehicles.begin(), queue.vehicles.end(), [](const QueuedVehicle& v) { return v.inserted; });
+        queue.vehicles.erase(end, queue.vehicles.end());
+        if (queue.failed) {
+            queue.nextAttempt = currentStep + queue.backoff;
+            queue.backoff = std::min(queue.backoff * 2, maxBackoff);
+        }
+        else {
+            queue.backoff = 1;
+        }
+    }
+    if (attempts) statistics.steps++;
+    statistics.insertions += inserted;
+    return inserted;
+}
+
+} // namespace plexe
@@ -0,0 +1,202 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#pragma once
+
+#include "plexe/plexe.h"
+
+#include <deque>
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace plexe {
+
+/**
+ * Keeps the queues of vehicles waiting to be inserted into SUMO and decides
+ * which insertions to attempt at each time step. The engine does not talk to
+ * SUMO itself: attempts are handed over in batches to an inserter function,
+ * which can send all of them within a single TraCI message.
+ *
+ * To keep the cost of a time step low when many vehicles are queued:
+ * - vehicle ids are computed once per vehicle, not at each attempt;
+ * - when an insertion on a lane fails, no other insertion on that lane is
+ *   attempted within the same time step, as it would fail as well;
+ * - a route whose insertions keep failing is retried after 1, 2, 4, ...
+ *   time steps, up to a maximum, instead of at every time step;
+ * - each route keeps a cursor to the first vehicle not yet attempted in the
+ *   current time step, so that rounds do not rescan the whole queue.
+ */
+class InsertionEngine {
+public:
+    /**
+     * An insertion attempt handed over to the inserter
+     */
+    struct Insertion {
+        const std::string* vehicleId;
+        const std::string* vehicleType;
+        const std::string* route;
+        // index of the lane where to insert, or -1 to let SUMO choose
+        int lane;
+        double position;
+        double speed;
+    };
+
+    /**
+     * Attempts a batch of insertions. For each of them, the inserter must
+     * push into success whether the vehicle has been inserted
+     */
+    typedef std::function<void(const std::vector<Insertion>& insertions, std::vector<bool>& success)> Inserter;
+
+    /**
+     * Removes vehicles which have been inserted by the inserter within the
+     * current time step
+     */
+    typedef std::function<void(const std::vector<Insertion>& insertions)> Remover;
+
+    /**
+     * Returns the number of lanes at the start of a route
+     */
+    typedef std::function<size_t(int route)> StartLanes;
+
+    struct Statistics {
+        // time steps in which at least one insertion has been attempted
+        long steps = 0;
+        // batches handed over to the inserter
+        long batches = 0;
+        long attempts = 0;
+        long insertions = 0;
+        long failures = 0;
+        // attempts not performed because the lane was already known to be full
+        long skipped = 0;
+        // insertions undone because a vehicle ahead on the route was refused
+        long removals = 0;
+    };
+
+    /**
+     * @param insertInOrder: if true, vehicles of a route are inserted in the
+     * order they have been queued, and the insertion of a route stops at the
+     * first failure. All the waiting vehicles of a route travel in the same
+     * batch, and the ones inserted behind a refused vehicle are removed
+     * again. Otherwise, each vehicle is inserted as soon as there is room,
+     * and vehicles without a lane are tried on all lanes
+     * @param maxBackoff: maximum number of time steps between two attempts for
+     * a route whose insertions fail. 1 retries at every time step
+     */
+    InsertionEngine(bool insertInOrder = true, int maxBackoff = 1);
+
+    /**
+     * Sets the names of vehicle types and routes, which are referred to by
+     * their index when queueing vehicles. Vehicles can be queued before,
+     * but the scenario must be set before the first step
+     */
+    void setScenario(const std::vector<std::string>& vehicleTypes, const std::vector<std::string>& routes, StartLanes startLanes);
+
+    /**
+     * Queues a vehicle for insertion
+     * @param route: index of the route
+     * @param vehicleType: index of the vehicle type. the vehicle is named
+     * <vehicle type>.<vehicleId>
+     * @param vehicleId: numeric part of the vehicle id. if negative, the
+     * vehicles of each type are numbered in the order they are queued
+     */
+    void enqueue(int route, int vehicleType, int lane, double position, double speed, int vehicleId = -1);
+
+    /**
+     * Consumes the id of a vehicle without queueing it, so that the ids of
+     * the following vehicles are the same as if it had been queued
+     */
+    void skip(int vehicleType);
+
+    /**
+     * Performs the insertions of one time step
+     * @param insert: attempts a batch of insertions
+     * @param remove: removes the vehicles inserted behind a refused one.
+     * only used when inserting in order
+     * @return the number of vehicles inserted
+     */
+    int step(const Inserter& insert, const Remover& remove);
+
+    /**
+     * Returns the number of vehicles waiting to be inserted
+     */
+    size_t pending() const;
+
+    const Statistics& getStatistics() const
+    {
+        return statistics;
+    }
+
+private:
+    struct QueuedVehicle {
+        // numeric part of the id, assigned when queued
+        int number;
+        // full id, built on the first attempt
+        std::string id;
+        int type;
+        int lane;
+        double position;
+        double speed;
+        // set when the vehicle cannot be attempted again in the current time step
+        bool done;
+        bool inserted;
+    };
+
+    struct RouteQueue {
+        std::deque<QueuedVehicle> vehicles;
+        // time step at which insertions are attempted again
+        long nextAttempt = 0;
+        // time steps to wait after the next failure
+        long backoff = 1;
+        // insertions for this route have been stopped in the current time step
+        bool stopped = false;
+        // insertions have been attempted in the current time step
+        bool attempted = false;
+        // at least one insertion failed in the current time step
+        bool failed = false;
+        // first vehicle which might still be attempted in the current time step
+        size_t next = 0;
+    };
+
+    /**
+     * Selects the lane for an attempt, or returns false if the vehicle
+     * cannot be attempted in this round
+     */
+    bool chooseLane(int route, QueuedVehicle& vehicle, int& lane);
+
+    bool insertInOrder;
+    long maxBackoff;
+    long currentStep;
+
+    std::vector<std::string> vehicleTypes;
+    std::vector<std::string> routes;
+    StartLanes startLanes;
+    // number of vehicles queued per vehicle type, used to name them
+    std::vector<int> vehiclesCount;
+    std::vector<RouteQueue> queues;
+    // lanes (route index, lane index) that refused a vehicle in the current time step
+    std::set<std::pair<int, int>> fullLanes;
+
+    Statistics statistics;
+};
+
+} // namespace plexe
@@ -19,6 +19,13 @@
 //
 
 #include "plexe/mobility/TraCIBaseTrafficManager.h"
+#include "plexe/PlexeManager.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
 
 using namespace veins;
 
@@ -34,15 +41,16 @@ void TraCIBaseTrafficManager::initialize(int stage)
 
         // empty all vectors
         vehicleTypeIds.clear();
-        vehiclesCount.clear();
         laneIds.clear();
         roadIds.clear();
         routeIds.clear();
         laneIdsOnEdge.clear();
         routeStartLaneIds.clear();
-        vehicleInsertQueue.clear();
+        routeFirstEdge.clear();
 
         insertInOrder = true;
+        insertionEngine = InsertionEngine(insertInOrder, par("maxInsertionBackoff"));
+        plexeManager = FindModule<PlexeManager*>::findGlobalModule();
 
         // search for the scenario manager. it will be needed to inject vehicles
         manager = FindModule<veins::TraCIScenarioManager*>::findGlobalModule();
@@ -113,53 +121,37 @@ void TraCIBaseTrafficManager::loadSumoScenario()
 {
     commandInterface = manager->getCommandInterface();
 
-    // get all the vehicle types
-    if (vehicleTypeIds.size() == 0) {
+    metadataCacheFile = getMetadataCacheFile();
+    if (!metadataCacheFile.empty() && loadMetadataCache()) {
+        EV << "Loaded scenario metadata from " << metadataCacheFile << std::endl;
+    }
+    else {
+        // get all the vehicle types
         std::list<std::string> vehTypes = commandInterface->getVehicleTypeIds();
         EV << "Having currently " << vehTypes.size() << " vehicle types" << std::endl;
         for (std::list<std::string>::const_iterator i = vehTypes.begin(); i != vehTypes.end(); ++i) {
             if (i->compare("DEFAULT_VEHTYPE") != 0) {
                 EV << "found vehType " << (*i) << std::endl;
                 vehicleTypeIds.push_back(*i);
-                // set counter of vehicles for this vehicle type to 0
-                vehiclesCount.push_back(0);
             }
         }
-    }
-    // get all roads
-    if (roadIds.size() == 0) {
+        // get all roads
         std::list<std::string> roads = commandInterface->getRoadIds();
         EV << "Having currently " << roads.size() << " roads in the scenario" << std::endl;
-        for (std::list<std::string>::const_iterator i = roads.begin(); i != roads.end(); ++i) {
-            EV << *i << std::endl;
-            roadIds.push_back(*i);
-        }
-    }
-    // get all lanes
-    if (laneIds.size() == 0) {
+        roadIds.assign(roads.begin(), roads.end());
+        // get all lanes. lanes on each edge are determined on first use
         std::list<std::string> lanes = commandInterface->getLaneIds();
         EV << "Having currently " << lanes.size() << " lanes in the scenario" << std::endl;
-        for (std::list<std::string>::const_iterator i = lanes.begin(); i != lanes.end(); ++i) {
-            EV << *i << std::endl;
-            laneIds.push_back(*i);
-            std::string edgeId = commandInterface->lane(*i).getRoadId();
-            laneIdsOnEdge[edgeId].push_back(*i);
-        }
-    }
-    // get all routes
-    if (routeIds.size() == 0) {
+        laneIds.assign(lanes.begin(), lanes.end());
+        // get all routes. their edges are fetched on first use
         std::list<std::string> routes = commandInterface->getRouteIds();
         EV << "Having currently " << routes.size() << " routes in the scenario" << std::endl;
-        for (std::list<std::string>::const_iterator i = routes.begin(); i != routes.end(); ++i) {
-            std::string routeId = *i;
-            EV << routeId << std::endl;
-            routeIds.push_back(routeId);
-            std::list<std::string> routeEdges = commandInterface->route(routeId).getRoadIds();
-            std::string firstEdge = *(routeEdges.begin());
-            EV << "First Edge of route " << routeId << " is " << firstEdge << std::endl;
-            routeStartLaneIds[routeId] = laneIdsOnEdge[firstEdge];
-        }
+        routeIds.assign(routes.begin(), routes.end());
+        metadataCacheDirty = true;
     }
+    auto startLanes = [this](int route) { return getRouteStartLaneIds(routeIds[route]).size(); };
+    insertionEngine.setScenario(vehicleTypeIds, routeIds, startLanes);
+
     // inform inheriting classes that scenario is loaded
     scenarioLoaded();
 
@@ -167,71 +159,238 @@ void TraCIBaseTrafficManager::loadSumoScenario()
     signalManager.subscribeCallback(manager, veins::TraCIScenarioManager::traciTimestepEndSignal, timestep);
 }
 
-void TraCIBaseTrafficManager::insertVehicles()
+void TraCIBaseTrafficManager::finish()
 {
-    // insert the vehicles in the queue
-    for (InsertQueue::iterator i = vehicleInsertQueue.begin(); i != vehicleInsertQueue.end(); ++i) {
-        std::string route = routeIds[i->first];
-        EV << "process " << route << std::endl;
-        std::deque<struct Vehicle>::iterator vi = i->second.begin();
-        while (vi != i->second.end() && i->second.size() != 0) {
-            bool suc = false;
-            struct Vehicle v = *vi;
-            std::string type = vehicleTypeIds[v.id];
-            std::stringstream veh;
-            int id = v.vehicleId < 0 ? vehiclesCount[v.id] : v.vehicleId;
-            veh << type << "." << id;
-
-            // do we need to put this vehicle on a particular lane, or can we put it on any?
-
-            if (v.lane == -1 && !insertInOrder) {
-
-                // try to insert that into any lane
-                for (unsigned int laneId = 0; !suc && laneId < routeStartLaneIds[route].size(); laneId++) {
-                    EV << "trying to add " << veh.str() << " with " << route << " vehicle type " << type << std::endl;
-                    suc = commandInterface->addVehicle(veh.str(), type, route, simTime(), v.position, v.speed, laneId);
-                    if (suc) break;
-                }
-                if (!suc) {
-                    // if we did not manager to insert a car on any lane, then this route is full and we can just stop
-                    // TODO: this is not true if we want to insert a vehicle not at the beginning of the route. fix this
-                    break;
-                }
-                else {
-                    EV << "successful inserted " << veh.str() << std::endl;
-                    vi = i->second.erase(vi);
-                    vehiclesCount[v.id] = vehiclesCount[v.id] + 1;
-                }
-            }
-            else {
-
-                // try to insert into desired lane
-                EV << "trying to add " << veh.str() << " with " << route << " vehicle type " << type << std::endl;
-                suc = commandInterface->addVehicle(veh.str(), type, route, simTime(), v.position, v.speed, v.lane);
-
-                if (suc) {
-                    EV << "successful inserted " << veh.str() << std::endl;
-                    vi = i->second.erase(vi);
-                    vehiclesCount[v.id] = vehiclesCount[v.id] + 1;
-                }
-                else {
-                    if (!insertInOrder) {
-                        vi++;
-                    }
-                    else {
-                        break;
-                    }
-                }
+    if (!metadataCacheFile.empty() && metadataCacheDirty) saveMetadataCache();
+    if (par("recordInsertionStatistics").boolValue()) {
+        const InsertionEngine::Statistics& stats = insertionEngine.getStatistics();
+        recordScalar("insertionSteps", stats.steps);
+        recordScalar("insertionBatches", stats.batches);
+        recordScalar("insertionAttempts", stats.attempts);
+        recordScalar("insertionFailures", stats.failures);
+        recordScalar("insertionSkipped", stats.skipped);
+        recordScalar("insertionRemovals", stats.removals);
+    }
+    cSimpleModule::finish();
+}
+
+const std::vector<std::string>& TraCIBaseTrafficManager::getLaneIdsOnEdge(const std::string& edgeId)
+{
+    auto lanes = laneIdsOnEdge.find(edgeId);
+    if (lanes != laneIdsOnEdge.end()) return lanes->second;
+
+    // SUMO names lanes as <edge id>_<lane index>, so there is no need to ask for the edge of each lane
+    std::vector<std::string>& edgeLanes = laneIdsOnEdge[edgeId];
+    std::string prefix = edgeId + "_";
+    for (const auto& laneId : laneIds) {
+        if (laneId.size() <= prefix.size() || laneId.compare(0, prefix.size(), prefix) != 0) continue;
+        if (laneId.find_first_not_of("0123456789", prefix.size()) != std::string::npos) continue;
+        edgeLanes.push_back(laneId);
+    }
+    return edgeLanes;
+}
+
+const std::vector<std::string>& TraCIBaseTrafficManager::getRouteStartLaneIds(const std::string& routeId)
+{
+    auto lanes = routeStartLaneIds.find(routeId);
+    if (lanes != routeStartLaneIds.end()) return lanes->second;
+
+    auto firstEdge = routeFirstEdge.find(routeId);
+    if (firstEdge == routeFirstEdge.end()) {
+        std::list<std::string> routeEdges = commandInterface->route(routeId).getRoadIds();
+        ASSERT2(!routeEdges.empty(), "route without edges");
+        firstEdge = routeFirstEdge.emplace(routeId, routeEdges.front()).first;
+        metadataCacheDirty = true;
+        EV << "First Edge of route " << routeId << " is " << firstEdge->second << std::endl;
+    }
+    return routeStartLaneIds[routeId] = getLaneIdsOnEdge(firstEdge->second);
+}
+
+namespace {
+
+const char* METADATA_CACHE_HEADER = "plexe-sumo-metadata 1";
+
+// FNV-1a, stable across runs and platforms
+void hashBytes(uint64_t& hash, const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+bool hashFile(uint64_t& hash, const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    hashBytes(hash, path.c_str(), path.size());
+    char buffer[65536];
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        hashBytes(hash, buffer, file.gcount());
+    }
+    return true;
+}
+
+std::string directoryOf(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+} // namespace
+
+std::string TraCIBaseTrafficManager::getMetadataCacheFile()
+{
+    std::string cacheDir = par("metadataCacheDir").stdstringValue();
+    if (cacheDir.empty()) return "";
+
+    // collect the files that define the scenario
+    std::vector<std::string> files;
+    if (manager->hasPar("launchConfig")) {
+        // sumo-launchd.py: all files copied to the launch directory
+        cXMLElement* launch = manager->par("launchConfig").xmlValue();
+        std::string basedir;
+        cXMLElement* basedirElement = launch->getFirstChildWithTag("basedir");
+        if (basedirElement && basedirElement->getAttribute("path")) basedir = basedirElement->getAttribute("path");
+        if (!basedir.empty() && basedir.back() != '/') basedir += "/";
+        for (cXMLElement* copy : launch->getChildrenByTagName("copy")) {
+            if (const char* file = copy->getAttribute("file")) files.push_back(basedir + file);
+        }
+    }
+    else if (manager->hasPar("configFile")) {
+        // forked SUMO: the configuration file and the network and route files it references
+        std::string configFile = manager->par("configFile").stdstringValue();
+        files.push_back(configFile);
+        cXMLElement* config = getEnvir()->getXMLDocument(configFile.c_str());
+        cXMLElement* input = config ? config->getFirstChildWithTag("input") : nullptr;
+        if (input) {
+            for (const char* tag : {"net-file", "route-files"}) {
+                cXMLElement* element = input->getFirstChildWithTag(tag);
+                if (!element || !element->getAttribute("value")) continue;
+                std::stringstream names(element->getAttribute("value"));
+                std::string name;
+                while (std::getline(names, name, ',')) files.push_back(directoryOf(configFile) + name);
             }
         }
     }
+    if (files.empty()) {
+        EV_WARN << "Cannot determine the files of the SUMO scenario. Scenario metadata will not be cached" << std::endl;
+        return "";
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto& file : files) {
+        if (!hashFile(hash, file)) {
+            EV_WARN << "Cannot read " << file << ". Scenario metadata will not be cached" << std::endl;
+            return "";
+        }
+    }
+
+    std::stringstream cacheFile;
+    cacheFile << cacheDir << "/sumo-metadata-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".cache";
+    return cacheFile.str();
 }
 
-void TraCIBaseTrafficManager::addVehicleToQueue(int routeId, struct Vehicle v)
+bool TraCIBaseTrafficManager::loadMetadataCache()
+{
+    std::ifstream cache(metadataCacheFile);
+    if (!cache) return false;
+
+    std::string line;
+    if (!std::getline(cache, line) || line != METADATA_CACHE_HEADER) {
+        EV_WARN << "Ignoring invalid metadata cache " << metadataCacheFile << std::endl;
+        return false;
+    }
+    std::vector<std::string> types, roads, lanes, routes;
+    std::map<std::string, std::string> firstEdges;
+    while (std::getline(cache, line)) {
+        std::stringstream fields(line);
+        std::string kind, id, edge;
+        fields >> kind >> id;
+        if (kind == "vtype") types.push_back(id);
+        else if (kind == "road") roads.push_back(id);
+        else if (kind == "lane") lanes.push_back(id);
+        else if (kind == "route") {
+            routes.push_back(id);
+            if (fields >> edge) firstEdges[id] = edge;
+        }
+        else {
+            EV_WARN << "Ignoring invalid metadata cache " << metadataCacheFile << std::endl;
+            return false;
+        }
+    }
+    vehicleTypeIds = types;
+    roadIds = roads;
+    laneIds = lanes;
+    routeIds = routes;
+    routeFirstEdge = firstEdges;
+    return true;
+}
+
+void TraCIBaseTrafficManager::saveMetadataCache()
+{
+    // write to a temporary file first, so that parallel runs never read a partial cache
+    std::stringstream tmpName;
+    tmpName << metadataCacheFile << "." << getpid() << ".tmp";
+    std::ofstream cache(tmpName.str());
+    if (!cache) {
+        EV_WARN << "Cannot write metadata cache " << metadataCacheFile << std::endl;
+        return;
+    }
+    cache << METADATA_CACHE_HEADER << "\n";
+    for (const auto& id : vehicleTypeIds) cache << "vtype " << id << "\n";
+    for (const auto& id : roadIds) cache << "road " << id << "\n";
+    for (const auto& id : laneIds) cache << "lane " << id << "\n";
+    for (const auto& id : routeIds) {
+        cache << "route " << id;
+        auto firstEdge = routeFirstEdge.find(id);
+        if (firstEdge != routeFirstEdge.end()) cache << " " << firstEdge->second;
+        cache << "\n";
+    }
+    cache.close();
+    if (std::rename(tmpName.str().c_str(), metadataCacheFile.c_str()) != 0) {
+        EV_WARN << "Cannot write metadata cache " << metadataCacheFile << std::endl;
+        std::remove(tmpName.str().c_str());
+    }
+}
+
+void TraCIBaseTrafficManager::insertVehicles()
 {
-    vehicleInsertQueue[routeId].push_back(v);
+    if (insertionEngine.pending() == 0) return;
+
+    // vehicles are inserted in batches through the Plexe command interface, if available
+    traci::CommandInterface* plexeCommandInterface = plexeManager ? plexeManager->getCommandInterface() : nullptr;
+    auto insert = [this, plexeCommandInterface](const std::vector<InsertionEngine::Insertion>& insertions, std::vector<bool>& success) {
+        if (plexeCommandInterface) {
+            plexeCommandInterface->addVehicles(insertions, success);
+        }
+        else {
+            for (const auto& v : insertions) success.push_back(commandInterface->addVehicle(*v.vehicleId, *v.vehicleType, *v.route, simTime(), v.position, v.speed, v.lane));
+        }
+    };
+    // vehicles inserted behind a refused one of the same route are removed again
+    auto remove = [this, plexeCommandInterface](const std::vector<InsertionEngine::Insertion>& insertions) {
+        if (plexeCommandInterface) {
+            plexeCommandInterface->removeVehicles(insertions);
+        }
+        else {
+            for (const auto& v : insertions) commandInterface->removeVehicle(*v.vehicleId);
+        }
+    };
+    int inserted = insertionEngine.step(insert, remove);
+    EV << "inserted " << inserted << " vehicles, " << insertionEngine.pending() << " waiting" << std::endl;
 }
 
+void TraCIBaseTrafficManager::addVehicleToQueue(int routeId, struct Vehicle v)
+{
+    // vehicles queued before a restored checkpoint are already in SUMO
+    if (plexeManager && plexeManager->isRestoringCheckpoint() && simTime() < plexeManager->getCheckpointTime()) {
+        insertionEngine.skip(v.id);
+        return;
+    }
+    insertionEngine.enqueue(routeId, v.id, v.lane, v.position, v.speed, v.vehicleId);
+}
 void TraCIBaseTrafficManager::addVehicleToQueue(std::string route, struct Vehicle v)
 {
     for (int i = 0; i < routeIds.size(); i++) {
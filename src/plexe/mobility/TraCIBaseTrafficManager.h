@@ -24,16 +24,20 @@
 #include <omnetpp.h>
 #include <queue>
 #include "plexe/utilities/DynamicPositionManager.h"
+#include "plexe/mobility/InsertionEngine.h"
 #include "veins/modules/mobility/traci/TraCIScenarioManager.h"
 #include "veins/modules/mobility/traci/TraCICommandInterface.h"
 #include "veins/modules/utility/SignalManager.h"
 
 namespace plexe {
 
+class PlexeManager;
+
 class TraCIBaseTrafficManager : public cSimpleModule {
 
 public:
     virtual void initialize(int stage) override;
+    virtual void finish() override;
     virtual int numInitStages() const override { return 2; }
 
     int findVehicleTypeIndex(std::string vehType);
@@ -43,6 +47,7 @@ public:
         : positions(DynamicPositionManager::getInstance())
     {
         insertVehiclesTrigger = 0;
+        metadataCacheDirty = false;
     }
 
     static enum ACTIVE_CONTROLLER strToController(const char* controller);
@@ -53,10 +58,40 @@ private:
      */
     void loadSumoScenario();
 
+    /**
+     * Returns the path of the metadata cache file for the current SUMO
+     * scenario, or an empty string if caching is disabled or the scenario
+     * files cannot be determined. The name of the file includes a hash of
+     * the content of all the files of the scenario
+     */
+    std::string getMetadataCacheFile();
+
+    /**
+     * Fills vehicle types, roads, lanes, and routes from the cache file.
+     * Returns false if the cache file does not exist or is invalid
+     */
+    bool loadMetadataCache();
+
+    /**
+     * Writes the metadata obtained so far into the cache file
+     */
+    void saveMetadataCache();
+
+    // cache file for scenario metadata. empty if caching is disabled
+    std::string metadataCacheFile;
+    // whether metadata has been obtained from SUMO after loading the cache
+    bool metadataCacheDirty;
+    // mapping between the route id and the id of its first edge, filled lazily
+    std::map<std::string, std::string> routeFirstEdge;
+
     // total number of vehicles generated
     int vehCounter;
     // should vehicles be inserted in order, or whenever there is room for doing so?
     bool insertInOrder;
+    // queues of vehicles to be inserted and logic deciding which insertions to attempt
+    InsertionEngine insertionEngine;
+    // used to insert vehicles in batches through the Plexe command interface. nullptr if there is none
+    PlexeManager* plexeManager;
 
     // at each simulation step, triggers insertion of vehicles in the queue
     cMessage* insertVehiclesTrigger;
@@ -68,17 +103,15 @@ protected:
     veins::TraCICommandInterface* commandInterface;
     // vector of all the vehicle types available
     std::vector<std::string> vehicleTypeIds;
-    // vector counting the number of vehicles inserted per each type
-    std::vector<int> vehiclesCount;
     // vector of all lanes ids
     std::vector<std::string> laneIds;
     // vector of all the roads ids
     std::vector<std::string> roadIds;
     // vector of all the routes ids
     std::vector<std::string> routeIds;
-    // mapping between the edge id and the ids of the lanes in that edge
+    // mapping between the edge id and the ids of the lanes in that edge. use getLaneIdsOnEdge(), which fills it lazily
     std::map<std::string, std::vector<std::string>> laneIdsOnEdge;
-    // mapping between the route id and the ids of the lanes at the start of the route
+    // mapping between the route id and the ids of the lanes at the start of the route. use getRouteStartLaneIds(), which fills it lazily
     std::map<std::string, std::vector<std::string>> routeStartLaneIds;
     // storage class that the traffic manager uses to store the formation, used for the initial setup of the position helper
     DynamicPositionManager& positions;
@@ -90,19 +123,27 @@ protected:
         int id; // id of the vehicle in sumo. this is the index of the vehicle type in the array of vehicle types
         int lane; // index of the lane where to insert (set to -1 to choose first free)
         float position; // position on the first edge
-        float speed; // start speed (-1 for lane speed?)
-        int vehicleId = -1;
+        float speed; // start speed (-1 for maximum speed)
+        int vehicleId = -1; // numeric part of the vehicle id. -1 numbers vehicles of each type in the order they are queued
     };
 
-    // queue of vehicles to be inserted. maps the index of a route in routeIds to a list of indexes of vehicle
-    // types in vehicleTypeIds
-    typedef std::map<int, std::deque<struct Vehicle>> InsertQueue;
-
 private:
-    InsertQueue vehicleInsertQueue;
     veins::SignalManager signalManager;
 
 protected:
+    /**
+     * Returns the ids of the lanes of an edge
+     */
+    const std::vector<std::string>& getLaneIdsOnEdge(const std::string& edgeId);
+
+    /**
+     * Returns the ids of the lanes of the first edge of a route
+     */
+    const std::vector<std::string>& getRouteStartLaneIds(const std::string& routeId);
+
+    /**
+     * Queues a vehicle for insertion. The id of the vehicle is determined here
+     */
     void addVehicleToQueue(int routeId, struct Vehicle v);
     void addVehicleToQueue(std::string route, struct Vehicle v);
 
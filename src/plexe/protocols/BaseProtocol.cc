@@ -27,6 +27,7 @@
 #include "plexe/PlexeManager.h"
 #include "plexe/driver/Veins11pRadioDriver.h"
 #include "plexe/messages/PlexeInterfaceControlInfo_m.h"
+#include "plexe/utilities/MessagePool.h"
 
 using namespace veins;
 
@@ -50,6 +51,11 @@ void BaseProtocol::initialize(int stage)
         busyTime = SimTime(0);
         seq_n = 0;
         recordData = 0;
+        sentFrames = 0;
+        frameCopies = 0;
+        encodedBeacons = 0;
+        encodedBeaconBytes = 0;
+        undecodableBeacons = 0;
 
         // get gates
         lowerControlIn = findGate("lowerControlIn");
@@ -78,6 +84,18 @@ void BaseProtocol::initialize(int stage)
         // priority of platooning message
         priority = par("priority");
         ASSERT2(priority >= 0 && priority <= 7, "priority value must be between 0 and 7");
+        // vehicles not heard for this long are removed from the duplicate detection table
+        knownBeacons.setMaxAge(SimTime(par("knownBeaconsMaxAge").doubleValue()));
+        // encode beacons with quantized fields, deriving their size from the encoding
+        if (par("compactBeacons").boolValue()) {
+            BeaconCodec::Resolution resolution;
+            resolution.position = par("positionResolution").doubleValueInUnit("m");
+            resolution.speed = par("speedResolution").doubleValueInUnit("mps");
+            resolution.acceleration = par("accelerationResolution").doubleValueInUnit("mps2");
+            resolution.time = par("timeResolution").doubleValueInUnit("s");
+            resolution.angleBits = par("angleBits");
+            beaconCodec.reset(new BeaconCodec(resolution, par("keyframeInterval")));
+        }
 
         // init messages for scheduleAt
         sendBeacon = new cMessage("sendBeacon");
@@ -115,9 +133,9 @@ void BaseProtocol::initialize(int stage)
         ASSERT(traci);
         traciVehicle = mobility->getVehicleCommandInterface();
         ASSERT(traciVehicle);
-        auto plexe = FindModule<PlexeManager*>::findGlobalModule();
-        ASSERT(plexe);
-        plexeTraci = plexe->getCommandInterface();
+        plexeManager = FindModule<PlexeManager*>::findGlobalModule();
+        ASSERT(plexeManager);
+        plexeTraci = plexeManager->getCommandInterface();
         plexeTraciVehicle.reset(new traci::CommandInterface::Vehicle(plexeTraci, mobility->getExternalId()));
         positionHelper = FindModule<BasePositionHelper*>::findSubModule(getParentModule());
         ASSERT(positionHelper);
@@ -128,6 +146,43 @@ void BaseProtocol::initialize(int stage)
         if (Veins11pRadioDriver* driver = FindModule<Veins11pRadioDriver*>::findSubModule(getParentModule())) {
             driver->registerNode(myId);
         }
+        if (plexeManager->isRestoringCheckpoint()) plexeManager->restoreProtocolState(myId, this);
+    }
+}
+
+void BaseProtocol::saveState(std::ostream& out) const
+{
+    out << seq_n << " " << knownBeacons.size(simTime());
+    knownBeacons.forEach(simTime(), [&out](int senderId, int sequenceNumber, simtime_t lastHeard) {
+        out << " " << senderId << " " << sequenceNumber << " " << lastHeard.raw();
+    });
+}
+
+void BaseProtocol::loadState(std::istream& in)
+{
+    size_t senders;
+    in >> seq_n >> senders;
+    knownBeacons.clear();
+    for (size_t i = 0; i < senders && in; i++) {
+        int senderId, sequenceNumber;
+        int64_t lastHeard;
+        in >> senderId >> sequenceNumber >> lastHeard;
+        knownBeacons.update(senderId, sequenceNumber, SimTime().setRaw(lastHeard));
+    }
+    if (in.fail()) throw cRuntimeError("Invalid protocol state in checkpoint for vehicle %d", myId);
+}
+
+void BaseProtocol::finish()
+{
+    BaseApplLayer::finish();
+    if (par("recordFrameCopies").boolValue()) {
+        recordScalar("sentFrames", sentFrames);
+        recordScalar("frameCopies", frameCopies);
+    }
+    if (beaconCodec) {
+        recordScalar("encodedBeacons", encodedBeacons);
+        recordScalar("meanEncodedBeaconSize", encodedBeacons > 0 ? (double) encodedBeaconBytes / encodedBeacons : 0, "B");
+        recordScalar("undecodableBeacons", undecodableBeacons);
     }
 }
 
@@ -170,19 +225,33 @@ void BaseProtocol::handleSelfMsg(cMessage* msg)
 
 void BaseProtocol::sendPlatooningMessage(int destinationAddress, enum PlexeRadioInterfaces interfaces)
 {
+    // during the fast-forward phase SUMO feeds the controllers, so there is nothing to send
+    if (plexeManager->isFastForwarding()) return;
     sendTo(createBeacon(destinationAddress).release(), interfaces);
 }
 
 void BaseProtocol::sendTo(BaseFrame1609_4* frame, enum PlexeRadioInterfaces interfaces)
 {
-    for (auto interface : radioOuts) {
-        if (interface.first & interfaces) {
-            BaseFrame1609_4* dup = frame->dup();
-            if (frame->getControlInfo()) dup->setControlInfo(frame->getControlInfo()->dup());
-            send(dup, interface.second);
-        }
+    // the last matching interface gets the original frame, so only the others need a copy
+    cGate* lastOut = nullptr;
+    for (const auto& interface : radioOuts) {
+        if (interface.first & interfaces) lastOut = interface.second;
+    }
+    if (!lastOut) {
+        delete frame;
+        return;
+    }
+    sentFrames++;
+    for (const auto& interface : radioOuts) {
+        if (!(interface.first & interfaces) || interface.second == lastOut) continue;
+        // dup() only copies the envelope: the encapsulated beacon is shared
+        // copy-on-write by the simulation kernel until someone modifies it
+        BaseFrame1609_4* dup = frame->dup();
+        if (frame->getControlInfo()) dup->setControlInfo(frame->getControlInfo()->dup());
+        frameCopies++;
+        send(dup, interface.second);
     }
-    delete frame;
+    send(frame, lastOut);
 }
 
 std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddress)
@@ -193,13 +262,13 @@ std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddre
     plexeTraciVehicle->getVehicleData(&data);
 
     // create and send beacon
-    auto wsm = veins::make_unique<BaseFrame1609_4>("", BEACON_TYPE);
+    std::unique_ptr<BaseFrame1609_4> wsm(new Pooled<BaseFrame1609_4>("", BEACON_TYPE));
     wsm->setRecipientAddress(LAddress::L2BROADCAST());
     wsm->setChannelNumber(static_cast<int>(Channel::cch));
     wsm->setUserPriority(priority);
 
     // create platooning beacon with data about the car
-    PlatooningBeacon* pkt = new PlatooningBeacon();
+    PlatooningBeacon* pkt = new Pooled<PlatooningBeacon>();
     pkt->setControllerAcceleration(data.u);
     pkt->setAcceleration(data.acceleration);
     pkt->setSpeed(data.speed);
@@ -213,22 +282,22 @@ std::unique_ptr<BaseFrame1609_4> BaseProtocol::createBeacon(int destinationAddre
     pkt->setSpeedY(data.speedY);
     pkt->setAngle(data.angle);
     pkt->setKind(BEACON_TYPE);
-    pkt->setByteLength(packetSize);
     pkt->setSequenceNumber(seq_n++);
+    if (beaconCodec) {
+        int size = beaconCodec->encode(pkt);
+        pkt->setByteLength(size);
+        encodedBeacons++;
+        encodedBeaconBytes += size;
+    }
+    else {
+        pkt->setByteLength(packetSize);
+    }
 
     wsm->encapsulate(pkt);
 
     return wsm;
 }
 
-bool BaseProtocol::isDuplicated(const PlatooningBeacon* beacon)
-{
-    auto sequenceNumber = knownBeacons.find(beacon->getVehicleId());
-    if (sequenceNumber == knownBeacons.end()) return false;
-    if (beacon->getSequenceNumber() > sequenceNumber->second) return false;
-    return true;
-}
-
 void BaseProtocol::receiveSignal(cComponent* source, simsignal_t signalID, bool v, cObject* details)
 {
 
@@ -278,12 +347,19 @@ void BaseProtocol::handleLowerMsg(cMessage* msg)
     if (PlatooningBeacon* epkt = dynamic_cast<PlatooningBeacon*>(enc)) {
 
         // if we're using multiple radios simultaneously, we might get duplicated beacons
-        if (isDuplicated(epkt)) {
+        if (knownBeacons.isKnown(epkt->getVehicleId(), epkt->getSequenceNumber(), simTime())) {
             duplicatedMessageReceived(epkt, frame);
             delete frame;
             return;
         }
-        knownBeacons[epkt->getVehicleId()] = epkt->getSequenceNumber();
+        // a delta encoded beacon can only be decoded if the beacon it refers to has been received
+        int reference = epkt->getReferenceSequenceNumber();
+        if (reference >= 0 && knownBeacons.getSequenceNumber(epkt->getVehicleId(), simTime()) != reference) {
+            undecodableBeacons++;
+            delete frame;
+            return;
+        }
+        knownBeacons.update(epkt->getVehicleId(), epkt->getSequenceNumber(), simTime());
 
         // invoke messageReceived() method of subclass
         messageReceived(epkt, frame);
@@ -308,25 +384,30 @@ void BaseProtocol::handleLowerMsg(cMessage* msg)
     }
 
     // find the application responsible for this beacon
-    PlexeInterfaceControlInfo* incomingInterface = new PlexeInterfaceControlInfo();
     auto interface = radioIns.find(msg->getArrivalGateId());
-    if (interface != radioIns.end())
-        incomingInterface->setInterfaces(interface->second);
-    else
-        incomingInterface->setInterfaces(0);
+    int incomingInterface = interface != radioIns.end() ? interface->second : 0;
 
     ApplicationMap::iterator app = apps.find(frame->getKind());
-    if (app != apps.end() && app->second.size() != 0) {
-        AppList applications = app->second;
-        for (AppList::iterator i = applications.begin(); i != applications.end(); i++) {
+    if (app != apps.end()) {
+        for (const auto& application : app->second) {
             // send the message to the applications responsible for it
             auto duplicate = frame->dup();
-            duplicate->setControlInfo(incomingInterface->dup());
-            send(duplicate, std::get<1>(*i));
+            PlexeInterfaceControlInfo* controlInfo = new PlexeInterfaceControlInfo();
+            controlInfo->setInterfaces(incomingInterface);
+            duplicate->setControlInfo(controlInfo);
+            send(duplicate, std::get<1>(application));
         }
     }
-    delete incomingInterface;
-    delete frame;
+
+    ReceiverMap::iterator receiver = receivers.find(frame->getKind());
+    if (receiver == receivers.end() || receiver->second.empty()) {
+        delete frame;
+        return;
+    }
+    // all receivers share the frame, which is deleted by the last one releasing it
+    drop(frame);
+    std::shared_ptr<const BaseFrame1609_4> shared(frame);
+    for (auto application : receiver->second) application->receiveFrame(shared, (enum PlexeRadioInterfaces) incomingInterface);
 }
 
 void BaseProtocol::handleUpperMsg(cMessage* msg)
@@ -400,4 +481,9 @@ void BaseProtocol::registerApplication(int applicationId, InputGate* appInputGat
     apps[applicationId].push_back(AppInOut(upperIn, upperOut, upperCntIn, upperCntOut));
 }
 
+void BaseProtocol::registerApplication(int applicationId, FrameReceiver* receiver)
+{
+    receivers[applicationId].push_back(receiver);
+}
+
 } // namespace plexe
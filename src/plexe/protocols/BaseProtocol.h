@@ -28,6 +28,9 @@
 #include "plexe/messages/PlatooningBeacon_m.h"
 #include "plexe/mobility/CommandInterface.h"
 #include "plexe/utilities/BasePositionHelper.h"
+#include "plexe/utilities/SequenceNumberTable.h"
+#include "plexe/protocols/FrameReceiver.h"
+#include "plexe/protocols/BeaconCodec.h"
 
 #include "plexe/driver/PlexeRadioDriverInterface.h"
 
@@ -39,6 +42,8 @@
 
 namespace plexe {
 
+class PlexeManager;
+
 using veins::BaseFrame1609_4;
 
 class BaseProtocol : public veins::BaseApplLayer {
@@ -72,11 +77,21 @@ private:
     // map of radio gates to radio interfaces type
     std::map<int, int> radioIns;
 
-    // map of known beacons (vehicle id, sequence number)
-    std::map<int, int> knownBeacons;
+    // number of frames handed to sendTo() and sent on at least one radio
+    long sentFrames;
+    // number of frame copies made to send the same frame on multiple radios
+    long frameCopies;
+
+    // last sequence number received from each vehicle, to detect duplicated beacons
+    SequenceNumberTable knownBeacons;
 
-    // indicates whether a beacon has already been received or not
-    bool isDuplicated(const PlatooningBeacon* beacon);
+    // encoder of compact beacons, null if beacons have a fixed size
+    std::unique_ptr<BeaconCodec> beaconCodec;
+    // number and total size of encoded beacons
+    long encodedBeacons;
+    long encodedBeaconBytes;
+    // delta encoded beacons dropped because the beacon they refer to was not received
+    long undecodableBeacons;
 
 protected:
     // determines position and role of each vehicle
@@ -121,6 +136,10 @@ protected:
     typedef cGate OtherGate;
     typedef std::map<OtherGate*, ThisGate*> GateConnections;
     GateConnections connections;
+    // applications receiving frames with a direct call, indexed by frame kind
+    typedef std::vector<FrameReceiver*> ReceiverList;
+    typedef std::map<int, ReceiverList> ReceiverMap;
+    ReceiverMap receivers;
 
     // messages for scheduleAt
     cMessage* sendBeacon;
@@ -208,6 +227,7 @@ protected:
     veins::TraCICommandInterface::Vehicle* traciVehicle;
     traci::CommandInterface* plexeTraci;
     std::unique_ptr<traci::CommandInterface::Vehicle> plexeTraciVehicle;
+    PlexeManager* plexeManager;
 
 public:
     // id for beacon message
@@ -218,13 +238,35 @@ public:
         sendBeacon = nullptr;
         recordData = nullptr;
         usedGates = 0;
+        plexeManager = nullptr;
     }
     virtual ~BaseProtocol();
 
     virtual void initialize(int stage) override;
+    virtual void finish() override;
 
     // register a higher level application by its id
     void registerApplication(int applicationId, InputGate* appInputGate, OutputGate* appOutputGate, ControlInputGate* appControlInputGate, ControlOutputGate* appControlOutputGate);
+
+    /**
+     * Registers a higher level application by its id, delivering frames
+     * with a direct call instead of through gates. Frames are neither
+     * duplicated nor sent, so this is cheaper than registering gates,
+     * especially with several applications
+     */
+    void registerApplication(int applicationId, FrameReceiver* receiver);
+
+    /**
+     * Writes the sequence number of the next beacon and the last sequence
+     * number received from each known sender, to be saved in a checkpoint
+     */
+    void saveState(std::ostream& out) const;
+
+    /**
+     * Restores the state written by saveState() when resuming from a
+     * checkpoint
+     */
+    void loadState(std::istream& in);
 };
 
 } // namespace plexe
@@ -0,0 +1,108 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/protocols/BeaconCodec.h"
+
+namespace plexe {
+
+BeaconCodec::BeaconCodec(const Resolution& resolution, int keyframeInterval)
+    : resolution(resolution)
+    , angleStep(2 * M_PI / (1 << resolution.angleBits))
+    , angleBytes((resolution.angleBits + 7) / 8)
+    , keyframeInterval(keyframeInterval)
+    , previousSequenceNumber(-1)
+    , sinceKeyframe(0)
+{
+    ASSERT2(resolution.position > 0 && resolution.speed > 0 && resolution.acceleration > 0 && resolution.time > 0, "beacon resolutions must be positive");
+    ASSERT2(resolution.angleBits > 0 && resolution.angleBits <= 30, "angleBits must be between 1 and 30");
+    ASSERT2(keyframeInterval >= 1, "keyframeInterval must be at least 1");
+    previous.fill(0);
+}
+
+int BeaconCodec::varintSize(int64_t value)
+{
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    int bytes = 1;
+    while (zigzag >= 0x80) {
+        zigzag >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+int BeaconCodec::encode(PlatooningBeacon* beacon)
+{
+    Values values;
+    values[TIME] = quantize(beacon->getTime(), resolution.time);
+    values[POSITION_X] = quantize(beacon->getPositionX(), resolution.position);
+    values[POSITION_Y] = quantize(beacon->getPositionY(), resolution.position);
+    values[LENGTH] = quantize(beacon->getLength(), resolution.position);
+    values[SPEED] = quantize(beacon->getSpeed(), resolution.speed);
+    values[SPEED_X] = quantize(beacon->getSpeedX(), resolution.speed);
+    values[SPEED_Y] = quantize(beacon->getSpeedY(), resolution.speed);
+    values[ACCELERATION] = quantize(beacon->getAcceleration(), resolution.acceleration);
+    values[CONTROLLER_ACCELERATION] = quantize(beacon->getControllerAcceleration(), resolution.acceleration);
+    // the angle is written as a fraction of a turn, so it must be in [0, 2pi)
+    double angle = std::fmod(beacon->getAngle(), 2 * M_PI);
+    if (angle < 0) angle += 2 * M_PI;
+    // angles right below 2pi are rounded up to a full turn, i.e., to 0
+    values[ANGLE] = quantize(angle, angleStep) & ((int64_t(1) << resolution.angleBits) - 1);
+
+    // receivers get the decoded values, not the original ones
+    beacon->setTime(values[TIME] * resolution.time);
+    beacon->setPositionX(values[POSITION_X] * resolution.position);
+    beacon->setPositionY(values[POSITION_Y] * resolution.position);
+    beacon->setLength(values[LENGTH] * resolution.position);
+    beacon->setSpeed(values[SPEED] * resolution.speed);
+    beacon->setSpeedX(values[SPEED_X] * resolution.speed);
+    beacon->setSpeedY(values[SPEED_Y] * resolution.speed);
+    beacon->setAcceleration(values[ACCELERATION] * resolution.acceleration);
+    beacon->setControllerAcceleration(values[CONTROLLER_ACCELERATION] * resolution.acceleration);
+    beacon->setAngle(values[ANGLE] * angleStep);
+
+    // one byte telling whether this is a keyframe, then the sender id and the sequence number
+    int size = 1 + varintSize(beacon->getVehicleId());
+    int sequenceNumber = beacon->getSequenceNumber();
+    bool delta = sinceKeyframe > 0 && sinceKeyframe < keyframeInterval && sequenceNumber == previousSequenceNumber + 1;
+    if (delta) {
+        size += varintSize(sequenceNumber - previousSequenceNumber);
+        for (int i = 0; i < FIELDS; i++) {
+            if (i != ANGLE) size += varintSize(values[i] - previous[i]);
+        }
+        size += varintSize(angleDelta(values[ANGLE], previous[ANGLE]));
+        beacon->setReferenceSequenceNumber(previousSequenceNumber);
+        sinceKeyframe++;
+    }
+    else {
+        size += varintSize(sequenceNumber);
+        for (int i = 0; i < FIELDS; i++) {
+            if (i != ANGLE) size += varintSize(values[i]);
+        }
+        size += angleBytes;
+        beacon->setReferenceSequenceNumber(-1);
+        sinceKeyframe = 1;
+    }
+
+    previous = values;
+    previousSequenceNumber = sequenceNumber;
+    return size;
+}
+
+} // namespace plexe
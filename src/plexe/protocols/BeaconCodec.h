@@ -0,0 +1,127 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef BEACONCODEC_H_
+#define BEACONCODEC_H_
+
+#include "plexe/plexe.h"
+#include "plexe/messages/PlatooningBeacon_m.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace plexe {
+
+/**
+ * Computes the on-air size of platooning beacons encoded with quantized
+ * fields. Each field is quantized with a configurable resolution and
+ * written as a zigzag variable length integer, so small values take fewer
+ * bytes. The angle is written with a fixed number of bits. With delta
+ * encoding, the fields of a beacon are written as the difference with
+ * respect to the previous beacon of the same sender, and a full beacon
+ * (keyframe) is sent periodically so that receivers that lost a beacon
+ * can decode again.
+ *
+ * The simulation does not carry the encoded bytes: the codec writes the
+ * quantized values back into the beacon, i.e., the values receivers
+ * would decode, and returns the size of the encoding
+ */
+class BeaconCodec {
+public:
+    struct Resolution {
+        // in m, used for positions and vehicle length
+        double position = 0.01;
+        // in m/s
+        double speed = 0.01;
+        // in m/s^2
+        double acceleration = 0.01;
+        // in s
+        double time = 0.001;
+        // the angle is quantized in 2^angleBits steps per turn
+        int angleBits = 16;
+    };
+
+    /**
+     * @param resolution quantization of the beacon fields
+     * @param keyframeInterval number of beacons between two keyframes. 1 disables delta encoding
+     */
+    BeaconCodec(const Resolution& resolution, int keyframeInterval = 1);
+
+    /**
+     * Quantizes the fields of a beacon, sets its reference sequence number
+     * if the beacon is delta encoded, and returns its encoded size in
+     * bytes. Beacons must be encoded in sending order
+     */
+    int encode(PlatooningBeacon* beacon);
+
+    /**
+     * Returns the number of bytes of the zigzag variable length encoding of
+     * the given value
+     */
+    static int varintSize(int64_t value);
+
+private:
+    enum Field {
+        TIME,
+        POSITION_X,
+        POSITION_Y,
+        LENGTH,
+        SPEED,
+        SPEED_X,
+        SPEED_Y,
+        ACCELERATION,
+        CONTROLLER_ACCELERATION,
+        ANGLE,
+        FIELDS
+    };
+    typedef std::array<int64_t, FIELDS> Values;
+
+    static int64_t quantize(double value, double step)
+    {
+        return std::llround(value / step);
+    }
+
+    /**
+     * Returns the difference between two quantized angles, taking the
+     * shortest way around the turn
+     */
+    int64_t angleDelta(int64_t angle, int64_t previous) const
+    {
+        const int64_t turn = int64_t(1) << resolution.angleBits;
+        int64_t delta = (angle - previous) & (turn - 1);
+        return delta >= turn / 2 ? delta - turn : delta;
+    }
+
+    Resolution resolution;
+    double angleStep;
+    int angleBytes;
+    int keyframeInterval;
+
+    // quantized fields and sequence number of the last encoded beacon
+    Values previous;
+    int previousSequenceNumber;
+    // beacons encoded since the last keyframe
+    int sinceKeyframe;
+};
+
+} // namespace plexe
+
+#endif /* BEACONCODEC_H_ */
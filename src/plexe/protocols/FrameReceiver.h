@@ -0,0 +1,58 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef FRAMERECEIVER_H_
+#define FRAMERECEIVER_H_
+
+#include <memory>
+
+#include "veins/modules/messages/BaseFrame1609_4_m.h"
+
+#include "plexe/driver/PlexeRadioDriverInterface.h"
+
+namespace plexe {
+
+/**
+ * Interface of applications receiving frames from the BaseProtocol with a
+ * direct call instead of through gates. The protocol neither duplicates the
+ * frame nor sends it as a message: all receivers of a frame share the same
+ * copy, which must not be modified
+ */
+class FrameReceiver {
+public:
+    virtual ~FrameReceiver()
+    {
+    }
+
+    /**
+     * Invoked by the protocol for each received frame of a type the
+     * receiver registered for. Implementations are methods of another
+     * module, so they must switch context (e.g., with Enter_Method_Silent())
+     * before scheduling events or logging
+     * @param frame: the received frame. Receivers can keep the pointer to
+     * use the frame after returning
+     * @param interface: the radio interface the frame has been received from
+     */
+    virtual void receiveFrame(std::shared_ptr<const veins::BaseFrame1609_4> frame, enum PlexeRadioInterfaces interface) = 0;
+};
+
+} // namespace plexe
+
+#endif /* FRAMERECEIVER_H_ */
@@ -39,6 +39,11 @@ protected:
     // sumo vehicle type of plaotoning cars
     std::string platooningVType;
 
+    // this scenario always feeds the controllers through SUMO
+    virtual void endFastForward() override
+    {
+    }
+
 public:
     AutoLaneChangeScenario()
     {
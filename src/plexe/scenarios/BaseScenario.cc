@@ -25,6 +25,9 @@
 #include "plexe/PlexeManager.h"
 #include "plexe/utilities/DynamicPositionManager.h"
 
+#include <functional>
+#include <sstream>
+
 using namespace veins;
 
 namespace plexe {
@@ -62,6 +65,7 @@ void BaseScenario::initialize(int stage)
             vehicleFile = par("vehicleFile").stdstringValue();
             vehicleType = par("vehicleType").stdstringValue();
         }
+        controllerProfile = par("controllerProfile").stdstringValue();
 
     }
     else if (stage == 1) {
@@ -87,12 +91,31 @@ void BaseScenario::initialize(int stage)
         // set the current lane
         plexeTraciVehicle->setFixedLane(positionHelper->getPlatoonLane());
         traciVehicle->setSpeedMode(0);
-        plexeTraciVehicle->usePrediction(usePrediction);
 
         if (positionHelper->getId() == 0) traci->guiView("View #0").trackVehicle(mobility->getExternalId());
+
+        auto plexe = FindModule<PlexeManager*>::findGlobalModule();
+        if (plexe->isFastForwarding()) {
+            startFastForward();
+            auto end = [this](veins::SignalPayload<simtime_t const&>) { endFastForward(); };
+            signalManager.subscribeCallback(plexe, PlexeManager::fastForwardEndSignal, end);
+        }
     }
 }
 
+void BaseScenario::startFastForward()
+{
+    if (positionHelper->isLeader()) return;
+    plexeTraciVehicle->enableAutoFeed(true, positionHelper->getMemberExternalId(positionHelper->getLeaderId()), positionHelper->getMemberExternalId(positionHelper->getFrontId()));
+}
+
+void BaseScenario::endFastForward()
+{
+    // called through the fast-forward end signal of the PlexeManager
+    Enter_Method_Silent();
+    if (!positionHelper->isLeader()) plexeTraciVehicle->enableAutoFeed(false);
+}
+
 double BaseScenario::getStandstillDistance(enum ACTIVE_CONTROLLER controller)
 {
     switch (controller) {
@@ -139,27 +162,79 @@ void BaseScenario::handleSelfMsg(cMessage* msg)
 {
 }
 
+namespace {
+
+template <typename T>
+std::string toParameterValue(T value)
+{
+    // same formatting used by the command interface when setting parameters
+    std::stringstream strValue;
+    strValue << value;
+    return strValue.str();
+}
+
+} // namespace
+
+traci::CommandInterface::ControllerProfile BaseScenario::getControllerProfile()
+{
+    traci::CommandInterface::ControllerProfile profile = {
+        // engine lag
+        {CC_PAR_ENGINE_TAU, toParameterValue(engineTau)},
+        {CC_PAR_UMIN, toParameterValue(uMin)},
+        {CC_PAR_UMAX, toParameterValue(uMax)},
+        // flatbed's parameters
+        {CC_PAR_FLATBED_KA, toParameterValue(flatbedKa)},
+        {CC_PAR_FLATBED_KV, toParameterValue(flatbedKv)},
+        {CC_PAR_FLATBED_KP, toParameterValue(flatbedKp)},
+        {CC_PAR_FLATBED_H, toParameterValue(flatbedH)},
+        {CC_PAR_FLATBED_D, toParameterValue(flatbedD)},
+        // use of controller acceleration and prediction
+        {PAR_USE_CONTROLLER_ACCELERATION, toParameterValue(useControllerAcceleration ? 1 : 0)},
+        {PAR_USE_PREDICTION, toParameterValue(usePrediction ? 1 : 0)},
+    };
+    // PATH's and Ploeg's CACC parameters. negative values keep SUMO defaults
+    auto addIfSet = [&profile](const char* parameter, double value) {
+        if (value >= 0) profile.emplace_back(parameter, toParameterValue(value));
+    };
+    addIfSet(CC_PAR_CACC_OMEGA_N, caccOmegaN);
+    addIfSet(CC_PAR_CACC_XI, caccXi);
+    addIfSet(CC_PAR_CACC_C1, caccC1);
+    addIfSet(PAR_CACC_SPACING, caccSpacing);
+    addIfSet(CC_PAR_PLOEG_KP, ploegKp);
+    addIfSet(CC_PAR_PLOEG_KD, ploegKd);
+    addIfSet(CC_PAR_PLOEG_H, ploegH);
+    if (useRealisticEngine) {
+        // the order is important
+        // 1. let sumo instantiate the realistic engine model
+        profile.emplace_back(CC_PAR_VEHICLE_ENGINE_MODEL, toParameterValue(CC_ENGINE_MODEL_REALISTIC));
+        // 2. tell the realistic engine model the location of the parameters file
+        profile.emplace_back(CC_PAR_VEHICLES_FILE, vehicleFile);
+        // 3. tell the realistic engine model which vehicle (in the specified parameters file) to use
+        profile.emplace_back(CC_PAR_VEHICLE_MODEL, vehicleType);
+    }
+    return profile;
+}
+
 void BaseScenario::initializeControllers()
 {
-    // engine lag
-    traciVehicle->setParameter(CC_PAR_ENGINE_TAU, engineTau);
-    traciVehicle->setParameter(CC_PAR_UMIN, uMin);
-    traciVehicle->setParameter(CC_PAR_UMAX, uMax);
-    // PATH's CACC parameters
-    plexeTraciVehicle->setPathCACCParameters(caccOmegaN, caccXi, caccC1, caccSpacing);
-    // Ploeg's parameters
-    plexeTraciVehicle->setPloegCACCParameters(ploegKp, ploegKd, ploegH);
-    // flatbed's parameters
-    traciVehicle->setParameter(CC_PAR_FLATBED_KA, flatbedKa);
-    traciVehicle->setParameter(CC_PAR_FLATBED_KV, flatbedKv);
-    traciVehicle->setParameter(CC_PAR_FLATBED_KP, flatbedKp);
-    traciVehicle->setParameter(CC_PAR_FLATBED_H, flatbedH);
-    traciVehicle->setParameter(CC_PAR_FLATBED_D, flatbedD);
+    // parameters shared with other vehicles are serialized once and sent within a single message
+    std::string name = controllerProfile;
+    auto profile = getControllerProfile();
+    if (name.empty()) {
+        // vehicles with the same parameters share the profile. registering
+        // a different profile under the same name throws, so a collision
+        // cannot go unnoticed
+        std::string parameters;
+        for (const auto& parameter : profile) parameters += parameter.first + "=" + parameter.second + ";";
+        std::stringstream hashedName;
+        hashedName << "profile-" << std::hex << std::hash<std::string>()(parameters);
+        name = hashedName.str();
+    }
+    plexeTraci->registerControllerProfile(name, profile);
+    plexeTraciVehicle->applyControllerProfile(name);
     // consensus parameters
     traciVehicle->setParameter(CC_PAR_VEHICLE_POSITION, positionHelper->getPosition());
     traciVehicle->setParameter(CC_PAR_PLATOON_SIZE, positionHelper->getPlatoonSize());
-    // use of controller acceleration
-    plexeTraciVehicle->useControllerAcceleration(useControllerAcceleration);
 
     VEHICLE_DATA vehicleData;
     // initialize own vehicle data
@@ -177,17 +252,6 @@ void BaseScenario::initializeControllers()
         vehicleData.u = 0;
         plexeTraciVehicle->setVehicleData(&vehicleData);
     }
-
-    if (useRealisticEngine) {
-        int engineModel = CC_ENGINE_MODEL_REALISTIC;
-        // the order is important
-        // 1. let sumo instantiate the realistic engine model
-        traciVehicle->setParameter(CC_PAR_VEHICLE_ENGINE_MODEL, engineModel);
-        // 2. tell the realistic engine model the location of the parameters file
-        traciVehicle->setParameter(CC_PAR_VEHICLES_FILE, vehicleFile);
-        // 3. tell the realistic engine model which vehicle (in the specified parameters file) to use
-        traciVehicle->setParameter(CC_PAR_VEHICLE_MODEL, vehicleType);
-    }
 }
 
 } // namespace plexe
@@ -26,6 +26,7 @@
 
 #include "plexe/utilities/BasePositionHelper.h"
 #include "plexe/mobility/CommandInterface.h"
+#include "veins/modules/utility/SignalManager.h"
 
 namespace plexe {
 
@@ -74,9 +75,32 @@ protected:
     bool useRealisticEngine;
     // vehicle type for realistic engine model
     std::string vehicleType;
+    // name of the controller profile shared with other vehicles
+    std::string controllerProfile;
 
     void initializeControllers();
 
+    /**
+     * Returns the controller parameters which do not depend on the role of
+     * the vehicle within the platoon, to be shared as a controller profile
+     */
+    virtual traci::CommandInterface::ControllerProfile getControllerProfile();
+
+    /**
+     * Invoked at initialization during the fast-forward phase, when no
+     * beacons are sent. Lets SUMO feed the controller of platoon members
+     * with the data of their leader and front vehicle
+     */
+    virtual void startFastForward();
+
+    /**
+     * Invoked at the end of the fast-forward phase. Stops feeding the
+     * controller through SUMO, as data now comes from beacons
+     */
+    virtual void endFastForward();
+
+    veins::SignalManager signalManager;
+
 public:
     BaseScenario()
     {
@@ -0,0 +1,170 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/traffic/DemandReader.h"
+#include "plexe/mobility/TraCIBaseTrafficManager.h"
+
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace plexe {
+
+std::unique_ptr<DemandReader> DemandReader::open(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) throw cRuntimeError("Cannot open demand file %s", fileName.c_str());
+    char magic[sizeof(BinaryDemandReader::MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    if (file.gcount() == sizeof(magic) && memcmp(magic, BinaryDemandReader::MAGIC, sizeof(magic)) == 0) {
+        return std::unique_ptr<DemandReader>(new BinaryDemandReader(fileName));
+    }
+    return std::unique_ptr<DemandReader>(new CsvDemandReader(fileName));
+}
+
+CsvDemandReader::CsvDemandReader(const std::string& fileName)
+    : fileName(fileName)
+    , file(fileName)
+    , lineNumber(0)
+{
+    if (!file) throw cRuntimeError("Cannot open demand file %s", fileName.c_str());
+}
+
+bool CsvDemandReader::next(DemandEvent& event)
+{
+    std::string line;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) fields.push_back(field);
+        // the controller can be left empty
+        if (fields.size() == 8) fields.push_back("");
+        if (fields.size() != 9) throw cRuntimeError("%s:%d: expected 9 fields, found %d", fileName.c_str(), lineNumber, (int) fields.size());
+
+        char* end;
+        auto number = [&](int i) {
+            double value = strtod(fields[i].c_str(), &end);
+            if (fields[i].empty() || *end != 0) throw cRuntimeError("%s:%d: invalid number \"%s\"", fileName.c_str(), lineNumber, fields[i].c_str());
+            return value;
+        };
+        event.time = number(0);
+        event.vehicleType = fields[1];
+        event.route = fields[2];
+        event.lane = number(3);
+        event.position = number(4);
+        event.speed = number(5);
+        event.platoonId = number(6);
+        event.platoonPosition = number(7);
+        if (fields[8].empty()) event.controller = -1;
+        else if (fields[8] == "DRIVER") event.controller = DRIVER;
+        else event.controller = TraCIBaseTrafficManager::strToController(fields[8].c_str());
+        return true;
+    }
+    return false;
+}
+
+const char BinaryDemandReader::MAGIC[8] = {'P', 'L', 'X', 'D', 'E', 'M', 'N', 'D'};
+
+BinaryDemandReader::BinaryDemandReader(const std::string& fileName)
+    : fileName(fileName)
+    , data(nullptr)
+    , size(0)
+    , cursor(0)
+{
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) throw cRuntimeError("Cannot open demand file %s", fileName.c_str());
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw cRuntimeError("Cannot read demand file %s", fileName.c_str());
+    }
+    size = info.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) throw cRuntimeError("Cannot map demand file %s", fileName.c_str());
+    data = static_cast<const char*>(map);
+    // records are read once, in order: let the kernel read ahead and drop pages behind
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    cursor = sizeof(MAGIC);
+    uint32_t version = read<uint32_t>();
+    if (version != VERSION) throw cRuntimeError("Unsupported version %u of demand file %s", version, fileName.c_str());
+    vehicleTypes = readNames();
+    routes = readNames();
+    if ((size - cursor) % RECORD_SIZE != 0) throw cRuntimeError("Truncated demand file %s", fileName.c_str());
+}
+
+BinaryDemandReader::~BinaryDemandReader()
+{
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+template <typename T>
+T BinaryDemandReader::read()
+{
+    if (cursor + sizeof(T) > size) throw cRuntimeError("Truncated demand file %s", fileName.c_str());
+    T value;
+    memcpy(&value, data + cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+
+std::vector<std::string> BinaryDemandReader::readNames()
+{
+    std::vector<std::string> names(read<uint32_t>());
+    for (auto& name : names) {
+        uint32_t length = read<uint32_t>();
+        if (cursor + length > size) throw cRuntimeError("Truncated demand file %s", fileName.c_str());
+        name.assign(data + cursor, length);
+        cursor += length;
+    }
+    return names;
+}
+
+bool BinaryDemandReader::next(DemandEvent& event)
+{
+    if (cursor >= size) return false;
+
+    size_t record = cursor;
+    event.time = read<double>();
+    event.position = read<float>();
+    event.speed = read<float>();
+    event.platoonId = read<int32_t>();
+    uint16_t vehicleType = read<uint16_t>();
+    uint16_t route = read<uint16_t>();
+    event.lane = read<int16_t>();
+    event.platoonPosition = read<int16_t>();
+    event.controller = read<int8_t>();
+    cursor = record + RECORD_SIZE;
+
+    if (vehicleType >= vehicleTypes.size() || route >= routes.size()) throw cRuntimeError("Invalid record at offset %lu of demand file %s", (unsigned long) record, fileName.c_str());
+    event.vehicleType = vehicleTypes[vehicleType];
+    event.route = routes[route];
+    return true;
+}
+
+} // namespace plexe
@@ -0,0 +1,124 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef DEMANDREADER_H_
+#define DEMANDREADER_H_
+
+#include "plexe/plexe.h"
+#include "plexe/CC_Const.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace plexe {
+
+/**
+ * A vehicle insertion event of a demand file
+ */
+struct DemandEvent {
+    double time;
+    std::string vehicleType;
+    std::string route;
+    int lane;
+    double position;
+    double speed;
+    // platoon of the vehicle, or -1 for vehicles not in a platoon
+    int platoonId;
+    int platoonPosition;
+    // controller of the vehicle, or -1 to use the default one
+    int controller;
+};
+
+/**
+ * Reads insertion events from a demand file, one at a time, so that only the
+ * events being injected are kept in memory. Two formats are supported:
+ *
+ * CSV, one event per line, with lines starting with # ignored:
+ *     time,vType,route,lane,position,speed,platoonId,platoonPosition,controller
+ * with time in s, position in m, speed in m/s, platoonId -1 for vehicles not in
+ * a platoon, and controller being ACC, CACC, PLOEG, CONSENSUS, FLATBED,
+ * DRIVER, or empty for the default one.
+ *
+ * Binary, as written by bin/plexe-demand.py, memory mapped: the "PLXDEMND"
+ * magic, a uint32 version, the vehicle types and the routes as uint32 count
+ * followed by uint32 length prefixed names, and then 32 bytes records with
+ * fields double time, float position, float speed, int32 platoonId, uint16
+ * vType index, uint16 route index, int16 lane, int16 platoonPosition, and
+ * int8 controller, in host byte order.
+ */
+class DemandReader {
+public:
+    virtual ~DemandReader()
+    {
+    }
+
+    /**
+     * Reads the next event. Returns false at the end of the file
+     */
+    virtual bool next(DemandEvent& event) = 0;
+
+    /**
+     * Opens a demand file, choosing the reader from its content
+     */
+    static std::unique_ptr<DemandReader> open(const std::string& fileName);
+};
+
+class CsvDemandReader : public DemandReader {
+public:
+    CsvDemandReader(const std::string& fileName);
+    virtual bool next(DemandEvent& event) override;
+
+private:
+    std::string fileName;
+    std::ifstream file;
+    int lineNumber;
+};
+
+class BinaryDemandReader : public DemandReader {
+public:
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 1;
+    static const size_t RECORD_SIZE = 32;
+
+    BinaryDemandReader(const std::string& fileName);
+    virtual ~BinaryDemandReader();
+    virtual bool next(DemandEvent& event) override;
+
+private:
+    /**
+     * Reads a value of the header, advancing the cursor
+     */
+    template <typename T>
+    T read();
+    std::vector<std::string> readNames();
+
+    std::string fileName;
+    const char* data;
+    size_t size;
+    size_t cursor;
+    std::vector<std::string> vehicleTypes;
+    std::vector<std::string> routes;
+};
+
+} // namespace plexe
+
+#endif /* DEMANDREADER_H_ */
@@ -0,0 +1,140 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/traffic/TraceTrafficManager.h"
+
+namespace plexe {
+
+Define_Module(TraceTrafficManager);
+
+void TraceTrafficManager::initialize(int stage)
+{
+
+    TraCIBaseTrafficManager::initialize(stage);
+
+    if (stage == 0) {
+
+        lookAhead = SimTime(par("lookAhead").doubleValue());
+        platoonInsertDistance = par("platoonInsertDistance").doubleValue();
+        platoonInsertHeadway = par("platoonInsertHeadway").doubleValue();
+        platoonLeaderHeadway = par("platoonLeaderHeadway").doubleValue();
+        injectMessage = new cMessage("injectVehicles");
+    }
+}
+
+void TraceTrafficManager::scenarioLoaded()
+{
+    for (int i = 0; i < vehicleTypeIds.size(); i++) vehicleTypeIndexes[vehicleTypeIds[i]] = i;
+    for (int i = 0; i < routeIds.size(); i++) routeIndexes[routeIds[i]] = i;
+
+    reader = DemandReader::open(par("demandFile").stdstringValue());
+    injectVehicles();
+}
+
+void TraceTrafficManager::handleSelfMsg(cMessage* msg)
+{
+
+    TraCIBaseTrafficManager::handleSelfMsg(msg);
+
+    if (msg == injectMessage) {
+        injectVehicles();
+    }
+}
+
+void TraceTrafficManager::fillBuffer()
+{
+    SimTime horizon = simTime() + lookAhead;
+    DemandEvent event;
+    // read until the first event past the window, which tells when to wake up next
+    while (reader && (buffer.empty() || SimTime(buffer.back().time) <= horizon)) {
+        if (!reader->next(event)) {
+            reader.reset();
+            break;
+        }
+        if (event.time < lastEventTime) throw cRuntimeError("Events of the demand file must be sorted by time (%g after %g)", event.time, lastEventTime);
+        lastEventTime = event.time;
+        buffer.push_back(event);
+    }
+    maxBufferedEvents = std::max(maxBufferedEvents, buffer.size());
+}
+
+void TraceTrafficManager::injectVehicles()
+{
+    fillBuffer();
+    while (!buffer.empty() && SimTime(buffer.front().time) <= simTime()) {
+        inject(buffer.front());
+        buffer.pop_front();
+    }
+    fillBuffer();
+    if (!buffer.empty()) scheduleAt(SimTime(buffer.front().time), injectMessage);
+}
+
+void TraceTrafficManager::inject(const DemandEvent& event)
+{
+    auto type = vehicleTypeIndexes.find(event.vehicleType);
+    if (type == vehicleTypeIndexes.end()) throw cRuntimeError("Unknown vehicle type %s in demand file", event.vehicleType.c_str());
+    auto route = routeIndexes.find(event.route);
+    if (route == routeIndexes.end()) throw cRuntimeError("Unknown route %s in demand file", event.route.c_str());
+
+    if (event.platoonId >= 0) {
+        bool leader = event.platoonPosition == 0;
+        VehicleInfo vehicleInfo;
+        if (event.controller >= 0) vehicleInfo.controller = (enum ACTIVE_CONTROLLER) event.controller;
+        else vehicleInfo.controller = leader ? ACC : controller;
+        vehicleInfo.id = nextVehicleId;
+        vehicleInfo.position = event.platoonPosition;
+        vehicleInfo.platoonId = event.platoonId;
+        vehicleInfo.distance = leader ? 2 : platoonInsertDistance;
+        vehicleInfo.headway = leader ? platoonLeaderHeadway : platoonInsertHeadway;
+        positions.addVehicleToPlatoon(nextVehicleId, vehicleInfo);
+        if (leader) {
+            PlatoonInfo info;
+            info.speed = event.speed;
+            info.lane = event.lane;
+            positions.setPlatoonInformation(event.platoonId, info);
+        }
+    }
+
+    struct Vehicle vehicle;
+    vehicle.id = type->second;
+    vehicle.lane = event.lane;
+    vehicle.position = event.position;
+    vehicle.speed = event.speed;
+    vehicle.vehicleId = nextVehicleId;
+    addVehicleToQueue(route->second, vehicle);
+
+    nextVehicleId++;
+    injectedVehicles++;
+}
+
+void TraceTrafficManager::finish()
+{
+    recordScalar("injectedVehicles", injectedVehicles);
+    recordScalar("maxBufferedEvents", maxBufferedEvents);
+    TraCIBaseTrafficManager::finish();
+}
+
+TraceTrafficManager::~TraceTrafficManager()
+{
+    cancelAndDelete(injectMessage);
+    injectMessage = nullptr;
+}
+
+} // namespace plexe
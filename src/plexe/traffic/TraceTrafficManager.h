@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef TRACETRAFFICMANAGER_H_
+#define TRACETRAFFICMANAGER_H_
+
+#include "plexe/mobility/TraCIBaseTrafficManager.h"
+#include "plexe/traffic/DemandReader.h"
+
+#include <deque>
+
+namespace plexe {
+
+/**
+ * Injects the vehicles listed in a demand file (see DemandReader for the
+ * formats). The file is read incrementally: only the events within a look
+ * ahead window are kept in memory, and vehicles are queued for insertion at
+ * their time
+ */
+class TraceTrafficManager : public TraCIBaseTrafficManager {
+
+public:
+    virtual void initialize(int stage) override;
+
+    TraceTrafficManager()
+    {
+        injectMessage = nullptr;
+        lookAhead = SimTime(0);
+        platoonInsertDistance = 0;
+        platoonInsertHeadway = 0;
+        platoonLeaderHeadway = 0;
+        nextVehicleId = 0;
+        lastEventTime = 0;
+        injectedVehicles = 0;
+        maxBufferedEvents = 0;
+    }
+    virtual ~TraceTrafficManager();
+    virtual void finish() override;
+
+protected:
+    // fires at the time of the next event to inject
+    cMessage* injectMessage;
+
+    // events are read from the demand file up to this far in the future
+    SimTime lookAhead;
+    // distance and headway of platoon members
+    double platoonInsertDistance;
+    double platoonInsertHeadway;
+    double platoonLeaderHeadway;
+
+    std::unique_ptr<DemandReader> reader;
+    // events read from the demand file but not injected yet
+    std::deque<DemandEvent> buffer;
+    // indexes of vehicle types and routes, by name
+    std::map<std::string, int> vehicleTypeIndexes;
+    std::map<std::string, int> routeIndexes;
+
+    // vehicles get consecutive ids, whatever their type, so that ids in the position helper are unique
+    int nextVehicleId;
+    // time of the last event read, to check that events are sorted
+    double lastEventTime;
+    long injectedVehicles;
+    size_t maxBufferedEvents;
+
+    virtual void handleSelfMsg(cMessage* msg) override;
+    virtual void scenarioLoaded() override;
+
+    /**
+     * Reads events up to the end of the look ahead window
+     */
+    void fillBuffer();
+
+    /**
+     * Queues the vehicles of the events that are due and schedules the next injection
+     */
+    void injectVehicles();
+
+    /**
+     * Queues the vehicle of an event and registers it in the position helper
+     */
+    void inject(const DemandEvent& event);
+};
+
+} // namespace plexe
+
+#endif
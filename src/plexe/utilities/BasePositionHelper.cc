@@ -91,23 +91,37 @@ void BasePositionHelper::setVariablesAfterFormationChange()
     leaderId = formation[0];
     frontId = isLeader() ? -1 : formation[position - 1];
     backId = isLast() ? -1 : formation[position + 1];
-    // automatically tell sumo about the platoon formation
-    // TODO: this will not work if the traffic manager has not a platooningVType parameter
-    // OR in case of heterogeneous platoons
+    // forget the sumo ids of the vehicles that left the platoon
+    for (auto externalId = memberExternalIds.begin(); externalId != memberExternalIds.end();) {
+        if (memberToPosition.count(externalId->first))
+            externalId++;
+        else
+            externalId = memberExternalIds.erase(externalId);
+    }
+    // automatically tell sumo about the platoon formation. only changes are sent
+    std::vector<std::string> members;
     if (isLeader()) {
-        cModule *traffic = findModuleByPath("<root>.traffic");
-        std::string platooningVType = traffic->par("platooningVType");
-        for (int i = 1; i < getPlatoonSize(); i++) {
-            std::stringstream ss;
-            ss << platooningVType << "." << getMemberId(i);
-            plexeTraciVehicle->addPlatoonMember(ss.str(), i);
-        }
+        for (int i = 1; i < getPlatoonSize(); i++) members.push_back(getMemberExternalId(getMemberId(i)));
     }
+    plexeTraciVehicle->setPlatoonMembers(members);
     colorVehicle();
 }
 
+const std::string& BasePositionHelper::getMemberExternalId(int vehicleId)
+{
+    auto externalId = memberExternalIds.find(vehicleId);
+    if (externalId != memberExternalIds.end()) return externalId->second;
+    // members share the vehicle type of this car, i.e., the part of the id before the dot
+    std::string ownId = getExternalId();
+    std::string prefix = ownId.substr(0, ownId.find_last_of('.') + 1);
+    return memberExternalIds[vehicleId] = prefix + std::to_string(vehicleId);
+}
+
 void BasePositionHelper::colorVehicle()
 {
+    // avoid recoloring the vehicle when its platoon did not change
+    if (platoonId == coloredPlatoonId) return;
+    coloredPlatoonId = platoonId;
     if (platoonId == -1)
         traciVehicle->setColor(veins::TraCIColor::fromTkColor("white"));
     else
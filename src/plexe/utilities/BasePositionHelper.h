@@ -71,6 +71,13 @@ public:
      */
     virtual int getLeaderId() const;
 
+    /**
+     * Returns the sumo id of a vehicle of the own platoon. By default,
+     * members are assumed to share the vehicle type of this car. Ids are
+     * resolved once and then cached
+     */
+    virtual const std::string& getMemberExternalId(int vehicleId);
+
     /**
      * Returns whether this vehicle is the leader of the platoon
      */
@@ -222,6 +229,12 @@ protected:
      */
     std::map<int, int> memberToPosition;
 
+    // sumo ids of platoon members, indexed by their numeric id
+    std::map<int, std::string> memberExternalIds;
+
+    // platoon the color of the vehicle refers to
+    int coloredPlatoonId;
+
     // used to retrieve the initial formation setup
     DynamicPositionManager& positions;
 
@@ -243,6 +256,7 @@ public:
         , platoonId(INVALID_PLATOON_ID)
         , platoonLane(-1)
         , platoonSpeed(-1)
+        , coloredPlatoonId(INVALID_PLATOON_ID)
         , positions(DynamicPositionManager::getInstance())
     {
     }
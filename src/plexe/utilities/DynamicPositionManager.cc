@@ -111,6 +111,15 @@ VehicleInfo DynamicPositionManager::getVehicleInfo(int vehicleId) const
         return i->second;
 }
 
+void DynamicPositionManager::clear()
+{
+    platoons.clear();
+    positions.clear();
+    vehToPlatoons.clear();
+    information.clear();
+    vehicleInfo.clear();
+}
+
 int DynamicPositionManager::getPlatoonId(int vehicleId) const
 {
     auto i = vehToPlatoons.find(vehicleId);
@@ -76,6 +76,7 @@ public:
     int getMemberId(int platoonId, const int position) const;
     void setVehicleInfo(int vehicleId, VehicleInfo info);
     VehicleInfo getVehicleInfo(int vehicleId) const;
+    void clear();
 
     static DynamicPositionManager& getInstance();
 
@@ -0,0 +1,114 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/utilities/FleetTelemetry.h"
+
+#include "veins/base/utils/FindModule.h"
+#include "veins/modules/mobility/traci/TraCIScenarioManager.h"
+
+#include "plexe/PlexeManager.h"
+#include "plexe/utilities/BasePositionHelper.h"
+
+namespace plexe {
+
+Define_Module(FleetTelemetry);
+
+FleetTelemetry::~FleetTelemetry()
+{
+    cancelAndDelete(sample);
+    sample = nullptr;
+}
+
+void FleetTelemetry::initialize()
+{
+    samplingPeriod = par("samplingPeriod");
+    if (samplingPeriod <= 0) return;
+
+    plexe = veins::FindModule<PlexeManager*>::findGlobalModule();
+    ASSERT(plexe);
+
+    nodeIdOut.setName("nodeId");
+    distanceOut.setName("distance");
+    relSpeedOut.setName("relativeSpeed");
+    speedOut.setName("speed");
+    posxOut.setName("posx");
+    posyOut.setName("posy");
+    accelerationOut.setName("acceleration");
+    controllerAccelerationOut.setName("controllerAcceleration");
+
+    sample = new cMessage("sample");
+    scheduleAt(simTime() + samplingPeriod, sample);
+}
+
+void FleetTelemetry::handleMessage(cMessage* msg)
+{
+    ASSERT(msg == sample);
+    sampleVehicles();
+    scheduleAt(simTime() + samplingPeriod, sample);
+}
+
+void FleetTelemetry::sampleVehicles()
+{
+    const auto scenarioManager = veins::TraCIScenarioManagerAccess().get();
+    traci::CommandInterface* plexeTraci = plexe->getCommandInterface();
+    // not connected to SUMO yet
+    if (!plexeTraci) return;
+
+    // platooning vehicles are the ones with a position helper
+    std::vector<std::pair<BasePositionHelper*, std::string>> vehicles;
+    std::vector<std::string> nodeIds;
+    for (const auto& host : scenarioManager->getManagedHosts()) {
+        BasePositionHelper* helper = dynamic_cast<BasePositionHelper*>(host.second->getSubmodule("helper"));
+        if (!helper) continue;
+        vehicles.emplace_back(helper, host.first);
+        nodeIds.push_back(host.first);
+    }
+    if (vehicles.empty()) return;
+
+    if (!plexeTraci->isUsingSubscriptions() && !warned) {
+        EV_WARN << "PlexeManager does not use subscriptions: vehicle data is fetched with one message per vehicle\n";
+        warned = true;
+    }
+    plexeTraci->prefetchSubscriptions(nodeIds);
+
+    for (const auto& vehicle : vehicles) {
+        traci::CommandInterface::Vehicle plexeTraciVehicle(plexeTraci, vehicle.second);
+        double distance, relSpeed;
+        VEHICLE_DATA data;
+        plexeTraciVehicle.getRadarMeasurements(distance, relSpeed);
+        plexeTraciVehicle.getVehicleData(&data);
+        nodeIdOut.record(vehicle.first->getId());
+        distanceOut.record(distance);
+        relSpeedOut.record(relSpeed);
+        speedOut.record(data.speed);
+        posxOut.record(data.positionX);
+        posyOut.record(data.positionY);
+        accelerationOut.record(data.acceleration);
+        controllerAccelerationOut.record(data.u);
+        samples++;
+    }
+}
+
+void FleetTelemetry::finish()
+{
+    if (samplingPeriod > 0) recordScalar("telemetrySamples", samples);
+}
+
+} // namespace plexe
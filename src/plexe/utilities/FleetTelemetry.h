@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef FLEETTELEMETRY_H_
+#define FLEETTELEMETRY_H_
+
+#include "plexe/plexe.h"
+
+namespace plexe {
+
+class PlexeManager;
+
+/**
+ * Samples the mobility data of all platooning vehicles with a single timer.
+ * At each sampling period, the data of all vehicles is fetched from SUMO
+ * with one message (if the PlexeManager uses subscriptions) and written to
+ * the same vectors recorded by BaseApp, with one entry per vehicle. The
+ * nodeId vector tells which vehicle the other entries with the same time
+ * refer to
+ */
+class FleetTelemetry : public cSimpleModule {
+public:
+    FleetTelemetry()
+        : sample(nullptr)
+        , plexe(nullptr)
+    {
+    }
+    ~FleetTelemetry() override;
+
+    void initialize() override;
+    void finish() override;
+
+protected:
+    void handleMessage(cMessage* msg) override;
+
+    /**
+     * Fetches and records the data of all platooning vehicles
+     */
+    void sampleVehicles();
+
+    simtime_t samplingPeriod;
+    cMessage* sample;
+    PlexeManager* plexe;
+    // whether the lack of subscriptions has already been reported
+    bool warned = false;
+
+    // number of samples recorded, i.e., of vehicles times sampling periods
+    long samples = 0;
+
+    // same vectors as BaseApp
+    cOutVector nodeIdOut;
+    cOutVector distanceOut, relSpeedOut;
+    cOutVector speedOut, posxOut, posyOut;
+    cOutVector accelerationOut, controllerAccelerationOut;
+};
+
+} // namespace plexe
+
+#endif /* FLEETTELEMETRY_H_ */
@@ -0,0 +1,80 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/utilities/MessagePool.h"
+
+namespace plexe {
+
+namespace {
+
+std::vector<std::vector<void*>*>& freeLists()
+{
+    static std::vector<std::vector<void*>*> lists;
+    return lists;
+}
+
+} // namespace
+
+MessagePool::Statistics& MessagePool::statistics()
+{
+    static Statistics stats;
+    return stats;
+}
+
+void MessagePool::registerFreeList(FreeList* freeList)
+{
+    freeLists().push_back(freeList);
+}
+
+void* MessagePool::allocate(FreeList& freeList, size_t size)
+{
+    Statistics& stats = statistics();
+    void* p;
+    if (freeList.empty()) {
+        p = ::operator new(size);
+        stats.allocations++;
+    }
+    else {
+        p = freeList.back();
+        freeList.pop_back();
+        stats.reuses++;
+    }
+    stats.live++;
+    if (stats.live > stats.maxLive) stats.maxLive = stats.live;
+    return p;
+}
+
+void MessagePool::release(FreeList& freeList, void* p)
+{
+    if (!p) return;
+    freeList.push_back(p);
+    statistics().live--;
+}
+
+void MessagePool::reset()
+{
+    for (auto freeList : freeLists()) {
+        for (void* p : *freeList) ::operator delete(p);
+        freeList->clear();
+    }
+    statistics() = Statistics();
+}
+
+} // namespace plexe
@@ -0,0 +1,126 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef MESSAGEPOOL_H_
+#define MESSAGEPOOL_H_
+
+#include "plexe/plexe.h"
+
+#include <typeinfo>
+#include <vector>
+
+namespace plexe {
+
+/**
+ * Keeps the memory of deleted messages to serve the next allocations of
+ * messages of the same type. Messages are recycled through the
+ * Pooled<T> class. Ownership is not affected: pooled messages are created
+ * with new, handed around, and deleted like any other message, only their
+ * memory is not given back to the heap
+ */
+class MessagePool {
+public:
+    struct Statistics {
+        // memory blocks taken from the heap
+        long allocations = 0;
+        // memory blocks served from the pool
+        long reuses = 0;
+        // pooled messages currently alive
+        long live = 0;
+        // maximum number of pooled messages alive at the same time
+        long maxLive = 0;
+    };
+
+    static const Statistics& getStatistics()
+    {
+        return statistics();
+    }
+
+    /**
+     * Gives the memory kept by the pool back to the heap and resets the
+     * statistics. Called when a new simulation starts
+     */
+    static void reset();
+
+private:
+    template <class T>
+    friend class Pooled;
+
+    typedef std::vector<void*> FreeList;
+
+    static Statistics& statistics();
+
+    /**
+     * Registers the free list of a message type, so that reset() can
+     * release its memory
+     */
+    static void registerFreeList(FreeList* freeList);
+
+    static void* allocate(FreeList& freeList, size_t size);
+    static void release(FreeList& freeList, void* p);
+};
+
+/**
+ * A message of type T whose memory is recycled by the MessagePool.
+ * Create it in place of T (e.g., new Pooled<PlatooningBeacon>()): copies
+ * made with dup() by the simulation kernel, MAC, or PHY are pooled as
+ * well, while receivers keep seeing a T
+ */
+template <class T>
+class Pooled final : public T {
+public:
+    using T::T;
+
+    Pooled<T>* dup() const override
+    {
+        return new Pooled<T>(*this);
+    }
+
+    // show the name of the message type in logs and inspectors
+    const char* getClassName() const override
+    {
+        return omnetpp::opp_typename(typeid(T));
+    }
+
+    static void* operator new(size_t size)
+    {
+        return MessagePool::allocate(freeList(), size);
+    }
+
+    static void operator delete(void* p)
+    {
+        MessagePool::release(freeList(), p);
+    }
+
+private:
+    static MessagePool::FreeList& freeList()
+    {
+        static MessagePool::FreeList* list = nullptr;
+        if (!list) {
+            list = new MessagePool::FreeList();
+            MessagePool::registerFreeList(list);
+        }
+        return *list;
+    }
+};
+
+} // namespace plexe
+
+#endif /* MESSAGEPOOL_H_ */
@@ -0,0 +1,127 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "plexe/utilities/SequenceNumberTable.h"
+
+namespace plexe {
+
+SequenceNumberTable::SequenceNumberTable(simtime_t maxAge, size_t initialCapacity)
+    : maxAge(maxAge)
+    , minCapacity(4)
+    , used(0)
+{
+    while (minCapacity < initialCapacity) minCapacity *= 2;
+    entries.assign(minCapacity, Entry{EMPTY, 0, SIMTIME_ZERO});
+}
+
+size_t SequenceNumberTable::slotOf(int senderId) const
+{
+    // vehicle ids are mostly consecutive. scramble them so that they
+    // spread over the whole table instead of forming a long cluster
+    uint32_t hash = static_cast<uint32_t>(senderId) * 2654435769u;
+    return (hash ^ (hash >> 16)) & (entries.size() - 1);
+}
+
+size_t SequenceNumberTable::find(int senderId, simtime_t now) const
+{
+    const size_t mask = entries.size() - 1;
+    // first slot of a forgotten sender met while probing, which can be reused
+    size_t reusable = entries.size();
+    for (size_t i = slotOf(senderId);; i = (i + 1) & mask) {
+        const Entry& entry = entries[i];
+        if (entry.senderId == senderId) return i;
+        if (entry.senderId == EMPTY) return reusable != entries.size() ? reusable : i;
+        if (reusable == entries.size() && isExpired(entry, now)) reusable = i;
+    }
+}
+
+bool SequenceNumberTable::update(int senderId, int sequenceNumber, simtime_t now)
+{
+    ASSERT2(senderId != EMPTY, "invalid sender id");
+    size_t slot = find(senderId, now);
+    Entry* entry = &entries[slot];
+    if (entry->senderId == senderId && !isExpired(*entry, now)) {
+        entry->lastHeard = now;
+        if (sequenceNumber <= entry->sequenceNumber) return false;
+        entry->sequenceNumber = sequenceNumber;
+        return true;
+    }
+    if (entry->senderId == EMPTY) {
+        // keep the load factor below 3/4 so that probing sequences stay short
+        if ((used + 1) * 4 > entries.size() * 3) {
+            rehash(now);
+            entry = &entries[find(senderId, now)];
+        }
+        used++;
+    }
+    *entry = Entry{senderId, sequenceNumber, now};
+    return true;
+}
+
+bool SequenceNumberTable::isKnown(int senderId, int sequenceNumber, simtime_t now) const
+{
+    const Entry& entry = entries[find(senderId, now)];
+    return entry.senderId == senderId && !isExpired(entry, now) && sequenceNumber <= entry.sequenceNumber;
+}
+
+int SequenceNumberTable::getSequenceNumber(int senderId, simtime_t now) const
+{
+    const Entry& entry = entries[find(senderId, now)];
+    if (entry.senderId != senderId || isExpired(entry, now)) return -1;
+    return entry.sequenceNumber;
+}
+
+void SequenceNumberTable::clear()
+{
+    entries.assign(minCapacity, Entry{EMPTY, 0, SIMTIME_ZERO});
+    used = 0;
+}
+
+size_t SequenceNumberTable::size(simtime_t now) const
+{
+    size_t live = 0;
+    for (const auto& entry : entries) {
+        if (entry.senderId != EMPTY && !isExpired(entry, now)) live++;
+    }
+    return live;
+}
+
+void SequenceNumberTable::rehash(simtime_t now)
+{
+    std::vector<Entry> old;
+    old.swap(entries);
+    size_t live = 0;
+    for (const auto& entry : old) {
+        if (entry.senderId != EMPTY && !isExpired(entry, now)) live++;
+    }
+    // leave room for at least as many senders as the ones still alive,
+    // shrinking the table if most of the senders have been forgotten
+    size_t newCapacity = minCapacity;
+    while (newCapacity < (live + 1) * 2) newCapacity *= 2;
+    entries.assign(newCapacity, Entry{EMPTY, 0, SIMTIME_ZERO});
+    used = 0;
+    for (const auto& entry : old) {
+        if (entry.senderId == EMPTY || isExpired(entry, now)) continue;
+        entries[find(entry.senderId, now)] = entry;
+        used++;
+    }
+}
+
+} // namespace plexe
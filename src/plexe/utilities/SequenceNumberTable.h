@@ -0,0 +1,143 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#ifndef SEQUENCENUMBERTABLE_H_
+#define SEQUENCENUMBERTABLE_H_
+
+#include "plexe/plexe.h"
+
+#include <limits>
+#include <vector>
+
+namespace plexe {
+
+/**
+ * Stores the last sequence number received from each sender, to detect
+ * duplicated or old beacons. The table uses open addressing with linear
+ * probing over a flat array, so a lookup usually touches a single cache
+ * line. Senders that have not been heard for more than maxAge are
+ * forgotten: their slots are reused for new senders and dropped when the
+ * table is resized, so the memory is bounded by the number of senders
+ * heard within maxAge rather than by all the senders ever heard
+ */
+class SequenceNumberTable {
+public:
+    /**
+     * @param maxAge time after which a sender that has not been heard is forgotten
+     * @param initialCapacity number of slots to start with. rounded up to a power of two
+     */
+    SequenceNumberTable(simtime_t maxAge = SimTime(10, SIMTIME_S), size_t initialCapacity = 16);
+
+    /**
+     * Stores the sequence number of a sender if it is newer than the known
+     * one or if the sender is unknown
+     *
+     * @param senderId id of the sender
+     * @param sequenceNumber sequence number of the received message
+     * @param now current simulation time
+     * @return true if the sequence number has been stored, false if the message is a duplicate
+     */
+    bool update(int senderId, int sequenceNumber, simtime_t now);
+
+    /**
+     * Tells whether a message with the given sequence number (or a newer
+     * one) has already been received from the sender
+     */
+    bool isKnown(int senderId, int sequenceNumber, simtime_t now) const;
+
+    /**
+     * Returns the last sequence number received from the sender, or -1 if
+     * the sender is unknown
+     */
+    int getSequenceNumber(int senderId, simtime_t now) const;
+
+    /**
+     * Forgets all senders
+     */
+    void clear();
+
+    /**
+     * Returns the number of senders heard within maxAge
+     */
+    size_t size(simtime_t now) const;
+
+    /**
+     * Returns the number of slots currently allocated
+     */
+    size_t capacity() const
+    {
+        return entries.size();
+    }
+
+    void setMaxAge(simtime_t maxAge)
+    {
+        this->maxAge = maxAge;
+    }
+
+    /**
+     * Calls visit(senderId, sequenceNumber, lastHeard) for each sender
+     * heard within maxAge, in no particular order
+     */
+    template <typename Visitor>
+    void forEach(simtime_t now, Visitor visit) const
+    {
+        for (const auto& entry : entries) {
+            if (entry.senderId != EMPTY && !isExpired(entry, now)) visit(entry.senderId, entry.sequenceNumber, entry.lastHeard);
+        }
+    }
+
+private:
+    struct Entry {
+        int senderId;
+        int sequenceNumber;
+        simtime_t lastHeard;
+    };
+
+    // marks slots that have never been used
+    static constexpr int EMPTY = std::numeric_limits<int>::min();
+
+    bool isExpired(const Entry& entry, simtime_t now) const
+    {
+        return now - entry.lastHeard > maxAge;
+    }
+
+    size_t slotOf(int senderId) const;
+
+    /**
+     * Returns the slot of the given sender or, if the sender is not in
+     * the table, the slot where it should be inserted
+     */
+    size_t find(int senderId, simtime_t now) const;
+
+    /**
+     * Reallocates the table, keeping only the senders heard within maxAge
+     */
+    void rehash(simtime_t now);
+
+    simtime_t maxAge;
+    size_t minCapacity;
+    // number of slots not EMPTY, including the ones of expired senders
+    size_t used;
+    std::vector<Entry> entries;
+};
+
+} // namespace plexe
+
+#endif /* SEQUENCENUMBERTABLE_H_ */
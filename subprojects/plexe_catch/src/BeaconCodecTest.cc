@@ -0,0 +1,178 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+
+#include "plexe/protocols/BeaconCodec.h"
+#include "plexe/messages/PlatooningBeacon_m.h"
+
+#include "testutils/Simulation.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace omnetpp;
+using plexe::BeaconCodec;
+using plexe::PlatooningBeacon;
+
+namespace {
+
+/**
+ * Fills a beacon with the values of a vehicle driving along the x axis
+ */
+void fillBeacon(PlatooningBeacon& beacon, int sequenceNumber)
+{
+    beacon.setVehicleId(37);
+    beacon.setSequenceNumber(sequenceNumber);
+    beacon.setTime(120.1 + sequenceNumber * 0.1);
+    beacon.setPositionX(15234.56789 + sequenceNumber * 2.7);
+    beacon.setPositionY(-3.2);
+    beacon.setLength(4);
+    beacon.setSpeed(27.5);
+    beacon.setSpeedX(27.5);
+    beacon.setSpeedY(0.01);
+    beacon.setAcceleration(0.123);
+    beacon.setControllerAcceleration(-0.456);
+    beacon.setAngle(M_PI / 2);
+}
+
+/**
+ * Returns the decoded angle of a beacon sent with the given one
+ */
+double encodeAngle(BeaconCodec& codec, double angle)
+{
+    PlatooningBeacon beacon;
+    beacon.setAngle(angle);
+    codec.encode(&beacon);
+    return beacon.getAngle();
+}
+
+} // namespace
+
+TEST_CASE("BeaconCodec varint size", "[protocols]")
+{
+    // zigzag encoding: 7 bits per byte, one of them for the sign
+    REQUIRE(BeaconCodec::varintSize(0) == 1);
+    REQUIRE(BeaconCodec::varintSize(63) == 1);
+    REQUIRE(BeaconCodec::varintSize(-64) == 1);
+    REQUIRE(BeaconCodec::varintSize(64) == 2);
+    REQUIRE(BeaconCodec::varintSize(-65) == 2);
+    REQUIRE(BeaconCodec::varintSize(8191) == 2);
+    REQUIRE(BeaconCodec::varintSize(-8192) == 2);
+    REQUIRE(BeaconCodec::varintSize(8192) == 3);
+    REQUIRE(BeaconCodec::varintSize(-8193) == 3);
+    REQUIRE(BeaconCodec::varintSize(std::numeric_limits<int64_t>::max()) == 10);
+    REQUIRE(BeaconCodec::varintSize(std::numeric_limits<int64_t>::min()) == 10);
+}
+
+TEST_CASE("BeaconCodec", "[protocols]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    BeaconCodec::Resolution resolution;
+    double angleStep = 2 * M_PI / (1 << resolution.angleBits);
+
+    SECTION("quantizes the fields with the configured resolution")
+    {
+        BeaconCodec codec(resolution);
+        PlatooningBeacon beacon;
+        fillBeacon(beacon, 0);
+        codec.encode(&beacon);
+        REQUIRE(beacon.getTime() == Approx(120.1).margin(resolution.time / 2));
+        REQUIRE(beacon.getPositionX() == Approx(15234.56789).margin(resolution.position / 2));
+        REQUIRE(beacon.getPositionY() == Approx(-3.2).margin(resolution.position / 2));
+        REQUIRE(beacon.getSpeedY() == Approx(0.01).margin(resolution.speed / 2));
+        REQUIRE(beacon.getAcceleration() == Approx(0.123).margin(resolution.acceleration / 2));
+        REQUIRE(beacon.getControllerAcceleration() == Approx(-0.456).margin(resolution.acceleration / 2));
+        REQUIRE(beacon.getAngle() == Approx(M_PI / 2).margin(angleStep / 2));
+
+        // decoded values are encoded to themselves
+        PlatooningBeacon decoded = beacon;
+        BeaconCodec again(resolution);
+        again.encode(&decoded);
+        REQUIRE(decoded.getPositionX() == beacon.getPositionX());
+        REQUIRE(decoded.getControllerAcceleration() == beacon.getControllerAcceleration());
+        REQUIRE(decoded.getAngle() == beacon.getAngle());
+    }
+
+    SECTION("computes the size of keyframes and delta encoded beacons")
+    {
+        BeaconCodec codec(resolution, 10);
+        PlatooningBeacon beacon;
+        beacon.setSequenceNumber(0);
+        // keyframe flag, sender id, sequence number, nine fields of one byte, and two bytes of angle
+        REQUIRE(codec.encode(&beacon) == 14);
+        REQUIRE(beacon.getReferenceSequenceNumber() == -1);
+
+        beacon.setSequenceNumber(1);
+        // keyframe flag, sender id, sequence number and ten fields of one byte
+        REQUIRE(codec.encode(&beacon) == 13);
+        REQUIRE(beacon.getReferenceSequenceNumber() == 0);
+
+        // a lost beacon breaks the chain of deltas
+        beacon.setSequenceNumber(3);
+        REQUIRE(codec.encode(&beacon) == 14);
+        REQUIRE(beacon.getReferenceSequenceNumber() == -1);
+    }
+
+    SECTION("sends a keyframe every keyframeInterval beacons")
+    {
+        BeaconCodec codec(resolution, 4);
+        int keyframeSize = 0, deltaSize = 0;
+        for (int i = 0; i < 12; i++) {
+            PlatooningBeacon beacon;
+            fillBeacon(beacon, i);
+            int size = codec.encode(&beacon);
+            if (i % 4 == 0) {
+                REQUIRE(beacon.getReferenceSequenceNumber() == -1);
+                keyframeSize = size;
+            }
+            else {
+                REQUIRE(beacon.getReferenceSequenceNumber() == i - 1);
+                deltaSize = size;
+            }
+        }
+        REQUIRE(deltaSize < keyframeSize);
+    }
+
+    SECTION("wraps negative and larger than a turn angles")
+    {
+        BeaconCodec codec(resolution);
+        REQUIRE(encodeAngle(codec, -M_PI / 2) == Approx(3 * M_PI / 2).margin(angleStep / 2));
+        REQUIRE(encodeAngle(codec, 2 * M_PI + 0.1) == Approx(0.1).margin(angleStep / 2));
+        REQUIRE(encodeAngle(codec, -4 * M_PI - 0.1) == Approx(2 * M_PI - 0.1).margin(angleStep / 2));
+        // rounded up to a full turn
+        REQUIRE(encodeAngle(codec, 2 * M_PI - angleStep / 4) == 0);
+        REQUIRE(encodeAngle(codec, -angleStep / 4) == 0);
+    }
+
+    SECTION("delta encodes angles across a full turn")
+    {
+        BeaconCodec codec(resolution, 10);
+        PlatooningBeacon beacon;
+        beacon.setSequenceNumber(0);
+        beacon.setAngle(-angleStep);
+        REQUIRE(codec.encode(&beacon) == 14);
+        beacon.setSequenceNumber(1);
+        beacon.setAngle(angleStep);
+        // a difference of two steps takes a single byte
+        REQUIRE(codec.encode(&beacon) == 13);
+        REQUIRE(beacon.getReferenceSequenceNumber() == 0);
+    }
+}
@@ -0,0 +1,279 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+
+#include "testutils/Simulation.h"
+
+#include "veins/modules/messages/BaseFrame1609_4_m.h"
+
+#include "plexe/apps/GeneralPlatooningApp.h"
+#include "plexe/apps/SimplePlatooningApp.h"
+#include "plexe/messages/PlatooningBeacon_m.h"
+#include "plexe/messages/PlexeInterfaceControlInfo_m.h"
+#include "plexe/protocols/BaseProtocol.h"
+#include "plexe/utilities/BasePositionHelper.h"
+#include "plexe/utilities/MessagePool.h"
+
+#include <memory>
+#include <vector>
+
+using namespace omnetpp;
+using plexe::BasePositionHelper;
+using plexe::BaseProtocol;
+using plexe::FrameReceiver;
+using plexe::MessagePool;
+using plexe::PlatooningBeacon;
+using plexe::PlexeInterfaceControlInfo;
+using plexe::Pooled;
+using veins::BaseFrame1609_4;
+
+// the modules below are not part of a network: they are not initialized
+// and frames are handed to BaseProtocol::handleLowerMsg() directly. a
+// default constructed position helper belongs to no platoon, so the
+// applications never reach SUMO
+
+namespace {
+
+/**
+ * BaseProtocol receiving frames as if they came from a radio
+ */
+class TestProtocol : public BaseProtocol {
+public:
+    TestProtocol(BasePositionHelper* helper)
+    {
+        positionHelper = helper;
+        myId = 0;
+    }
+
+    void receive(BaseFrame1609_4* frame)
+    {
+        take(frame);
+        handleLowerMsg(frame);
+    }
+};
+
+/**
+ * SimplePlatooningApp counting the beacons it handles
+ */
+class TestSimplePlatooningApp : public plexe::SimplePlatooningApp {
+public:
+    TestSimplePlatooningApp(BasePositionHelper* helper)
+    {
+        positionHelper = helper;
+    }
+
+    int beacons = 0;
+    double speed = 0;
+
+protected:
+    void processPlatoonBeacon(const PlatooningBeacon* pb) override
+    {
+        beacons++;
+        speed += pb->getSpeed();
+        SimplePlatooningApp::processPlatoonBeacon(pb);
+    }
+};
+
+/**
+ * GeneralPlatooningApp counting the beacons it handles. the maneuvers are
+ * not created, so beacons are not passed on to them
+ */
+class TestGeneralPlatooningApp : public plexe::GeneralPlatooningApp {
+public:
+    TestGeneralPlatooningApp(BasePositionHelper* helper)
+    {
+        positionHelper = helper;
+    }
+
+    int beacons = 0;
+    double speed = 0;
+
+protected:
+    void onPlatoonBeacon(const PlatooningBeacon* pb) override
+    {
+        beacons++;
+        speed += pb->getSpeed();
+    }
+};
+
+/**
+ * Receiver keeping the last frame it got
+ */
+class FrameKeeper : public FrameReceiver {
+public:
+    std::shared_ptr<const BaseFrame1609_4> kept;
+
+    void receiveFrame(std::shared_ptr<const BaseFrame1609_4> frame, enum plexe::PlexeRadioInterfaces interface) override
+    {
+        kept = frame;
+    }
+};
+
+BaseFrame1609_4* makeBeaconFrame(int sequenceNumber, int kind = BaseProtocol::BEACON_TYPE)
+{
+    BaseFrame1609_4* frame = new Pooled<BaseFrame1609_4>("", kind);
+    PlatooningBeacon* beacon = new Pooled<PlatooningBeacon>();
+    beacon->setVehicleId(3);
+    beacon->setSequenceNumber(sequenceNumber);
+    beacon->setSpeed(27.5);
+    beacon->setAcceleration(0.5);
+    beacon->setControllerAcceleration(0.4);
+    beacon->setPositionX(1000);
+    beacon->setPositionY(12);
+    beacon->setByteLength(200);
+    beacon->setKind(kind);
+    frame->encapsulate(beacon);
+    return frame;
+}
+
+/**
+ * Copies made for each application by gate delivery: BaseProtocol
+ * duplicates the frame and attaches a control info, the application
+ * decapsulates the beacon and deletes everything. sending through the gate
+ * and the event per application are not included
+ */
+void deliverThroughGates(BaseFrame1609_4* frame, int applications)
+{
+    for (int i = 0; i < applications; i++) {
+        auto duplicate = frame->dup();
+        PlexeInterfaceControlInfo* controlInfo = new PlexeInterfaceControlInfo();
+        controlInfo->setInterfaces(plexe::VEINS_11P);
+        duplicate->setControlInfo(controlInfo);
+        delete duplicate->removeControlInfo();
+        cPacket* enc = duplicate->decapsulate();
+        delete enc;
+        delete duplicate;
+    }
+    delete frame;
+}
+
+const int BEACONS = 1000;
+
+} // namespace
+
+TEST_CASE("Direct frame dispatch", "[protocols]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    BasePositionHelper helper;
+    TestProtocol protocol(&helper);
+    TestSimplePlatooningApp simpleApp(&helper);
+    TestGeneralPlatooningApp generalApp(&helper);
+    protocol.registerApplication(BaseProtocol::BEACON_TYPE, &simpleApp);
+    protocol.registerApplication(BaseProtocol::BEACON_TYPE, &generalApp);
+    long live = MessagePool::getStatistics().live;
+
+    SECTION("delivers each beacon once to every registered application")
+    {
+        protocol.receive(makeBeaconFrame(0));
+        protocol.receive(makeBeaconFrame(1));
+        REQUIRE(simpleApp.beacons == 2);
+        REQUIRE(generalApp.beacons == 2);
+        REQUIRE(simpleApp.speed == Approx(2 * 27.5));
+        REQUIRE(generalApp.speed == Approx(2 * 27.5));
+        // nobody holds the frames, so they have been deleted
+        REQUIRE(MessagePool::getStatistics().live == live);
+    }
+
+    SECTION("does not deliver duplicated beacons")
+    {
+        protocol.receive(makeBeaconFrame(5));
+        protocol.receive(makeBeaconFrame(5));
+        protocol.receive(makeBeaconFrame(4));
+        REQUIRE(simpleApp.beacons == 1);
+        REQUIRE(generalApp.beacons == 1);
+        REQUIRE(MessagePool::getStatistics().live == live);
+    }
+
+    SECTION("delivers frames only to the applications registered for their kind")
+    {
+        protocol.receive(makeBeaconFrame(0, BaseProtocol::BEACON_TYPE + 100));
+        REQUIRE(simpleApp.beacons == 0);
+        REQUIRE(generalApp.beacons == 0);
+        REQUIRE(MessagePool::getStatistics().live == live);
+    }
+
+    SECTION("keeps the frame while a receiver holds it")
+    {
+        FrameKeeper keeper;
+        protocol.registerApplication(BaseProtocol::BEACON_TYPE, &keeper);
+        protocol.receive(makeBeaconFrame(0));
+        REQUIRE(simpleApp.beacons == 1);
+        REQUIRE(generalApp.beacons == 1);
+        // frame and beacon
+        REQUIRE(MessagePool::getStatistics().live == live + 2);
+        REQUIRE(keeper.kept->getKind() == BaseProtocol::BEACON_TYPE);
+        keeper.kept.reset();
+        REQUIRE(MessagePool::getStatistics().live == live);
+    }
+}
+
+TEST_CASE("Direct frame dispatch performance", "[protocols][!benchmark]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    BasePositionHelper helper;
+    TestProtocol one(&helper), two(&helper), five(&helper);
+    std::vector<std::unique_ptr<TestSimplePlatooningApp>> simpleApps;
+    std::vector<std::unique_ptr<TestGeneralPlatooningApp>> generalApps;
+    // alternate simple and general applications
+    auto registerApps = [&](TestProtocol& protocol, int applications) {
+        for (int i = 0; i < applications; i++) {
+            if (i % 2 == 0) {
+                simpleApps.emplace_back(new TestSimplePlatooningApp(&helper));
+                protocol.registerApplication(BaseProtocol::BEACON_TYPE, simpleApps.back().get());
+            }
+            else {
+                generalApps.emplace_back(new TestGeneralPlatooningApp(&helper));
+                protocol.registerApplication(BaseProtocol::BEACON_TYPE, generalApps.back().get());
+            }
+        }
+    };
+    registerApps(one, 1);
+    registerApps(two, 2);
+    registerApps(five, 5);
+    int sequenceNumber = 0;
+
+    BENCHMARK("1000 beacons, copies of gate delivery, 1 app")
+    {
+        for (int i = 0; i < BEACONS; i++) deliverThroughGates(makeBeaconFrame(sequenceNumber++), 1);
+    }
+    BENCHMARK("1000 beacons dispatched directly, 1 app")
+    {
+        for (int i = 0; i < BEACONS; i++) one.receive(makeBeaconFrame(sequenceNumber++));
+    }
+    BENCHMARK("1000 beacons, copies of gate delivery, 2 apps")
+    {
+        for (int i = 0; i < BEACONS; i++) deliverThroughGates(makeBeaconFrame(sequenceNumber++), 2);
+    }
+    BENCHMARK("1000 beacons dispatched directly, 2 apps")
+    {
+        for (int i = 0; i < BEACONS; i++) two.receive(makeBeaconFrame(sequenceNumber++));
+    }
+    BENCHMARK("1000 beacons, copies of gate delivery, 5 apps")
+    {
+        for (int i = 0; i < BEACONS; i++) deliverThroughGates(makeBeaconFrame(sequenceNumber++), 5);
+    }
+    BENCHMARK("1000 beacons dispatched directly, 5 apps")
+    {
+        for (int i = 0; i < BEACONS; i++) five.receive(makeBeaconFrame(sequenceNumber++));
+    }
+    REQUIRE(simpleApps[0]->beacons > 0);
+    REQUIRE(generalApps[0]->beacons == simpleApps[1]->beacons);
+}
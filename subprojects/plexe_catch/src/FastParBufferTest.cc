@@ -0,0 +1,155 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "catch2/catch.hpp"
+
+#include "plexe/CC_Const.h"
+#include "plexe/mobility/FastParBuffer.h"
+
+#include "testutils/Simulation.h"
+
+#include <veins/modules/mobility/traci/ParBuffer.h>
+
+using namespace omnetpp;
+using plexe::VEHICLE_DATA;
+using plexe::traci::FastParBuffer;
+using veins::ParBuffer;
+
+namespace {
+
+VEHICLE_DATA makeVehicleData()
+{
+    VEHICLE_DATA data;
+    data.index = 3;
+    data.speed = 100 / 3.6;
+    data.acceleration = -1.23456789;
+    data.positionX = 12345.678901;
+    data.positionY = -0.000123456;
+    data.time = 61.1;
+    data.length = 4;
+    data.u = 1e-12;
+    data.speedX = 27.7;
+    data.speedY = 0;
+    data.angle = 3.14159265358979;
+    return data;
+}
+
+template <typename Buffer>
+std::string encode(const VEHICLE_DATA& data)
+{
+    Buffer buf;
+    buf << data.index << data.speed << data.acceleration << data.positionX << data.positionY << data.time << data.length << data.u << data.speedX << data.speedY << data.angle;
+    return buf.str();
+}
+
+template <typename Buffer>
+VEHICLE_DATA decode(const std::string& v)
+{
+    VEHICLE_DATA data = {};
+    Buffer buf(v);
+    buf >> data.index >> data.speed >> data.acceleration >> data.positionX >> data.positionY >> data.time >> data.length >> data.u >> data.speedX >> data.speedY >> data.angle;
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("FastParBuffer", "[traci]")
+{
+    VEHICLE_DATA data = makeVehicleData();
+
+    SECTION("encodes like ParBuffer")
+    {
+        REQUIRE(encode<FastParBuffer>(data) == encode<ParBuffer>(data));
+    }
+
+    SECTION("encodes strings like ParBuffer")
+    {
+        FastParBuffer fast;
+        fast << std::string("key") << 2;
+        ParBuffer reference;
+        reference << std::string("key") << 2;
+        REQUIRE(fast.str() == reference.str());
+    }
+
+    SECTION("throws when values do not fit")
+    {
+        DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+        FastParBuffer fast;
+        REQUIRE_THROWS_AS(fast << std::string(600, 'x'), cRuntimeError);
+        // "1.23457e+06" takes 11 bytes plus the separator
+        FastParBuffer many;
+        for (int i = 0; i < 40; i++) many << 1234567.0;
+        REQUIRE_THROWS_AS(many << 1234567.0 << 1234567.0 << 1234567.0, cRuntimeError);
+    }
+
+    SECTION("decodes like ParBuffer")
+    {
+        std::string v = encode<ParBuffer>(data);
+        VEHICLE_DATA fast = decode<FastParBuffer>(v);
+        VEHICLE_DATA reference = decode<ParBuffer>(v);
+        REQUIRE(fast.index == reference.index);
+        REQUIRE(fast.speed == reference.speed);
+        REQUIRE(fast.acceleration == reference.acceleration);
+        REQUIRE(fast.positionX == reference.positionX);
+        REQUIRE(fast.positionY == reference.positionY);
+        REQUIRE(fast.time == reference.time);
+        REQUIRE(fast.length == reference.length);
+        REQUIRE(fast.u == reference.u);
+        REQUIRE(fast.speedX == reference.speedX);
+        REQUIRE(fast.speedY == reference.speedY);
+        REQUIRE(fast.angle == reference.angle);
+    }
+
+    SECTION("leaves values untouched when input is exhausted")
+    {
+        std::string v = "1.5";
+        double a = 0, b = 7;
+        FastParBuffer buf(v);
+        buf >> a >> b;
+        REQUIRE(a == 1.5);
+        REQUIRE(b == 7);
+    }
+}
+
+TEST_CASE("FastParBuffer performance", "[traci][!benchmark]")
+{
+    VEHICLE_DATA data = makeVehicleData();
+    std::string v = encode<ParBuffer>(data);
+    VEHICLE_DATA decoded;
+
+    BENCHMARK("encode VEHICLE_DATA with ParBuffer")
+    {
+        v = encode<ParBuffer>(data);
+    }
+    BENCHMARK("encode VEHICLE_DATA with FastParBuffer")
+    {
+        v = encode<FastParBuffer>(data);
+    }
+    BENCHMARK("decode VEHICLE_DATA with ParBuffer")
+    {
+        decoded = decode<ParBuffer>(v);
+    }
+    BENCHMARK("decode VEHICLE_DATA with FastParBuffer")
+    {
+        decoded = decode<FastParBuffer>(v);
+    }
+    REQUIRE(decoded.index == data.index);
+}
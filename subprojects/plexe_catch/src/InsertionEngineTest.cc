@@ -0,0 +1,233 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "catch2/catch.hpp"
+
+#include "plexe/mobility/InsertionEngine.h"
+
+#include <algorithm>
+#include <map>
+
+using plexe::InsertionEngine;
+
+namespace {
+
+/**
+ * Stands in for SUMO: each lane admits a limited number of vehicles per time step
+ */
+struct FakeRoad {
+    int admittedPerStep;
+    std::map<int, int> admitted;
+    std::vector<std::string> inserted;
+    long batches = 0;
+    long removals = 0;
+
+    explicit FakeRoad(int admittedPerStep)
+        : admittedPerStep(admittedPerStep)
+    {
+    }
+
+    InsertionEngine::Inserter inserter()
+    {
+        return [this](const std::vector<InsertionEngine::Insertion>& insertions, std::vector<bool>& success) {
+            batches++;
+            for (const auto& insertion : insertions) {
+                bool fits = admitted[insertion.lane] < admittedPerStep;
+                if (fits) {
+                    admitted[insertion.lane]++;
+                    inserted.push_back(*insertion.vehicleId);
+                }
+                success.push_back(fits);
+            }
+        };
+    }
+
+    InsertionEngine::Remover remover()
+    {
+        return [this](const std::vector<InsertionEngine::Insertion>& insertions) {
+            removals++;
+            for (const auto& insertion : insertions) {
+                admitted[insertion.lane]--;
+                inserted.erase(std::find(inserted.begin(), inserted.end(), *insertion.vehicleId));
+            }
+        };
+    }
+
+    void nextStep()
+    {
+        admitted.clear();
+    }
+};
+
+InsertionEngine makeEngine(bool insertInOrder, int maxBackoff, int lanes)
+{
+    InsertionEngine engine(insertInOrder, maxBackoff);
+    engine.setScenario({"vtypeauto", "vtypehuman"}, {"platoon_route"}, [lanes](int) { return lanes; });
+    return engine;
+}
+
+/**
+ * Queues platoons of 8 vehicles spread over the lanes, like PlatoonsTrafficManager does
+ */
+void queuePlatoons(InsertionEngine& engine, int vehicles, int lanes)
+{
+    for (int i = 0; i < vehicles; i++) engine.enqueue(0, 0, i % lanes, 10000 - (i / lanes) * 9.0, 27.8);
+}
+
+} // namespace
+
+TEST_CASE("InsertionEngine", "[mobility]")
+{
+    SECTION("numbers vehicles per type in queue order")
+    {
+        InsertionEngine engine = makeEngine(true, 1, 1);
+        engine.enqueue(0, 0, 0, 100, 0);
+        engine.enqueue(0, 1, 0, 90, 0);
+        engine.enqueue(0, 0, 0, 80, 0, 42);
+        engine.enqueue(0, 0, 0, 70, 0);
+        FakeRoad road(10);
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 4);
+        REQUIRE(road.inserted == std::vector<std::string>({"vtypeauto.0", "vtypehuman.0", "vtypeauto.42", "vtypeauto.2"}));
+        REQUIRE(engine.pending() == 0);
+        REQUIRE(road.batches == 1);
+    }
+
+    SECTION("does not retry a full lane within a step")
+    {
+        InsertionEngine engine = makeEngine(false, 1, 2);
+        for (int i = 0; i < 4; i++) engine.enqueue(0, 0, -1, 100 - i * 10, 0);
+        engine.enqueue(0, 0, 0, 50, 0);
+        FakeRoad road(1);
+        // the first round fills lane 0, the second one lane 1
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 2);
+        REQUIRE(road.batches == 2);
+        // the vehicle queued for lane 0 is not attempted again after the first round
+        REQUIRE(engine.getStatistics().attempts == 8);
+        REQUIRE(engine.getStatistics().skipped == 2);
+        road.nextStep();
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 2);
+        REQUIRE(engine.pending() == 1);
+    }
+
+    SECTION("tries vehicles without a lane on all lanes")
+    {
+        InsertionEngine engine = makeEngine(false, 1, 3);
+        for (int i = 0; i < 4; i++) engine.enqueue(0, 0, -1, 0, 0);
+        FakeRoad road(1);
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 3);
+        REQUIRE(engine.pending() == 1);
+    }
+
+    SECTION("stops a route at the first failure when inserting in order")
+    {
+        InsertionEngine engine = makeEngine(true, 1, 1);
+        for (int i = 0; i < 5; i++) engine.enqueue(0, 0, 0, 100 - i * 10, 0);
+        FakeRoad road(0);
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 0);
+        // all vehicles travel in the same batch
+        REQUIRE(engine.getStatistics().attempts == 5);
+        road.nextStep();
+        engine.enqueue(0, 0, 0, 0, 0);
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 0);
+        REQUIRE(engine.getStatistics().attempts == 11);
+        REQUIRE(engine.pending() == 6);
+    }
+
+    SECTION("does not insert the followers of a refused vehicle")
+    {
+        InsertionEngine engine = makeEngine(true, 1, 2);
+        engine.enqueue(0, 0, 0, 100, 0);
+        engine.enqueue(0, 0, 1, 100, 0);
+        engine.enqueue(0, 0, 0, 90, 0);
+        FakeRoad road(1);
+        // lane 0 is busy, so the leader is refused while its follower on lane 1 would fit
+        road.admitted[0] = 1;
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 0);
+        // the follower has been removed again
+        REQUIRE(road.inserted.empty());
+        REQUIRE(road.removals == 1);
+        REQUIRE(engine.getStatistics().removals == 1);
+        road.nextStep();
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 2);
+        REQUIRE(road.inserted == std::vector<std::string>({"vtypeauto.0", "vtypeauto.1"}));
+        road.nextStep();
+        REQUIRE(engine.step(road.inserter(), road.remover()) == 1);
+        REQUIRE(engine.pending() == 0);
+    }
+
+    SECTION("inserts a platoon with one batch per step")
+    {
+        InsertionEngine engine = makeEngine(true, 1, 4);
+        queuePlatoons(engine, 32, 4);
+        FakeRoad road(4);
+        // four rows per step fit, the rest of the platoon waits
+        for (int step = 1; step <= 2; step++) {
+            REQUIRE(engine.step(road.inserter(), road.remover()) == 16);
+            REQUIRE(road.batches == step);
+            road.nextStep();
+        }
+        REQUIRE(engine.pending() == 0);
+        REQUIRE(road.removals == 0);
+    }
+
+    SECTION("backs off a route whose insertions fail")
+    {
+        InsertionEngine engine = makeEngine(true, 4, 1);
+        engine.enqueue(0, 0, 0, 0, 0);
+        FakeRoad road(0);
+        // attempts at steps 1, 2, 4, 8, 12, ...
+        for (int step = 1; step <= 12; step++) engine.step(road.inserter(), road.remover());
+        REQUIRE(road.batches == 5);
+        road.admittedPerStep = 1;
+        for (int step = 13; step <= 16; step++) engine.step(road.inserter(), road.remover());
+        REQUIRE(engine.pending() == 0);
+    }
+}
+
+TEST_CASE("InsertionEngine performance", "[mobility][!benchmark]")
+{
+    const int vehicles = 10000;
+    const int lanes = 4;
+
+    BENCHMARK("insert 10000 platoon vehicles at once")
+    {
+        for (int i = 0; i < 10; i++) {
+            InsertionEngine engine = makeEngine(true, 1, lanes);
+            queuePlatoons(engine, vehicles, lanes);
+            FakeRoad road(vehicles);
+            engine.step(road.inserter(), road.remover());
+            REQUIRE(engine.pending() == 0);
+        }
+    }
+
+    BENCHMARK("insert 10000 platoon vehicles, 25 per lane and step")
+    {
+        for (int i = 0; i < 10; i++) {
+            InsertionEngine engine = makeEngine(false, 8, lanes);
+            queuePlatoons(engine, vehicles, lanes);
+            FakeRoad road(25);
+            while (engine.pending() != 0) {
+                engine.step(road.inserter(), road.remover());
+                road.nextStep();
+            }
+        }
+    }
+}
@@ -0,0 +1,141 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+
+#include "catch2/catch.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+// round trip latency of the local transports that could carry TraCI traffic.
+// message sizes are those of a typical Plexe set command and of its status response
+
+namespace {
+
+const size_t REQUEST_SIZE = 96;
+const size_t RESPONSE_SIZE = 16;
+
+bool sendAll(int fd, const char* buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = ::send(fd, buf, len, 0);
+        if (n <= 0) return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool receiveAll(int fd, char* buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = ::recv(fd, buf, len, 0);
+        if (n <= 0) return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+// answers every request with a response, like a TraCI server would
+void serve(int fd)
+{
+    char request[REQUEST_SIZE];
+    char response[RESPONSE_SIZE] = {};
+    while (receiveAll(fd, request, REQUEST_SIZE)) {
+        if (!sendAll(fd, response, RESPONSE_SIZE)) break;
+    }
+    ::close(fd);
+}
+
+void roundTrip(int fd)
+{
+    char request[REQUEST_SIZE] = {};
+    char response[RESPONSE_SIZE];
+    REQUIRE(sendAll(fd, request, REQUEST_SIZE));
+    REQUIRE(receiveAll(fd, response, RESPONSE_SIZE));
+}
+
+// opens a loopback TCP connection configured like veins::TraCIConnection
+void tcpPair(int& client, int& server)
+{
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(listener >= 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    REQUIRE(::bind(listener, (sockaddr*) &address, sizeof(address)) == 0);
+    REQUIRE(::listen(listener, 1) == 0);
+    socklen_t length = sizeof(address);
+    REQUIRE(::getsockname(listener, (sockaddr*) &address, &length) == 0);
+
+    client = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(::connect(client, (sockaddr*) &address, sizeof(address)) == 0);
+    server = ::accept(listener, nullptr, nullptr);
+    REQUIRE(server >= 0);
+    ::close(listener);
+
+    int on = 1;
+    ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    ::setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+void unixPair(int& client, int& server)
+{
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    client = fds[0];
+    server = fds[1];
+}
+
+} // namespace
+
+TEST_CASE("Loopback transports", "[traci][!benchmark]")
+{
+    int client, server;
+
+    SECTION("TCP")
+    {
+        tcpPair(client, server);
+    }
+    SECTION("Unix domain socket")
+    {
+        unixPair(client, server);
+    }
+
+    std::thread echo(serve, server);
+    // warm up
+    for (int i = 0; i < 1000; i++) roundTrip(client);
+
+    BENCHMARK("1000 TraCI-sized round trips")
+    {
+        for (int i = 0; i < 1000; i++) roundTrip(client);
+    }
+
+    ::close(client);
+    echo.join();
+}
@@ -0,0 +1,154 @@
+//
+// Copyright (C) 2025 Michele Segata <segata@ccs-labs.org>
+//
+// SPDX-License-Identifier: GPL-2.0-or-later
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "catch2/catch.hpp"
+
+#include "plexe/utilities/SequenceNumberTable.h"
+
+#include "testutils/Simulation.h"
+
+#include <map>
+
+using namespace omnetpp;
+using plexe::SequenceNumberTable;
+
+namespace {
+
+const int SENDERS = 10000;
+
+/**
+ * Receives one beacon from each sender, with every sender being heard
+ * twice (e.g., over two radios), and returns the number of duplicates
+ */
+int receiveFromAllSenders(SequenceNumberTable& table, int sequenceNumber, simtime_t now)
+{
+    int duplicates = 0;
+    for (int sender = 0; sender < SENDERS; sender++) {
+        if (!table.update(sender, sequenceNumber, now)) duplicates++;
+        if (!table.update(sender, sequenceNumber, now)) duplicates++;
+    }
+    return duplicates;
+}
+
+/**
+ * Same as receiveFromAllSenders() with the map previously used by BaseProtocol
+ */
+int receiveFromAllSenders(std::map<int, int>& table, int sequenceNumber)
+{
+    int duplicates = 0;
+    for (int sender = 0; sender < SENDERS; sender++) {
+        for (int copy = 0; copy < 2; copy++) {
+            auto known = table.find(sender);
+            if (known != table.end() && sequenceNumber <= known->second) {
+                duplicates++;
+                continue;
+            }
+            table[sender] = sequenceNumber;
+        }
+    }
+    return duplicates;
+}
+
+} // namespace
+
+TEST_CASE("SequenceNumberTable", "[utilities]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    SequenceNumberTable table(SimTime(1, SIMTIME_S));
+
+    SECTION("detects duplicated and old sequence numbers")
+    {
+        REQUIRE(table.update(7, 0, SimTime(0)));
+        REQUIRE_FALSE(table.update(7, 0, SimTime(0)));
+        REQUIRE(table.update(7, 2, SimTime(0)));
+        REQUIRE_FALSE(table.update(7, 1, SimTime(0)));
+        REQUIRE(table.isKnown(7, 2, SimTime(0)));
+        REQUIRE_FALSE(table.isKnown(7, 3, SimTime(0)));
+        REQUIRE_FALSE(table.isKnown(8, 0, SimTime(0)));
+        REQUIRE(table.update(8, 0, SimTime(0)));
+        REQUIRE(table.size(SimTime(0)) == 2);
+    }
+
+    SECTION("forgets senders not heard within the maximum age")
+    {
+        REQUIRE(table.update(7, 5, SimTime(0)));
+        REQUIRE(table.update(8, 5, SimTime(0)));
+        // hearing a duplicate still tells that the sender is around
+        REQUIRE_FALSE(table.update(8, 5, SimTime(0.8)));
+        REQUIRE_FALSE(table.isKnown(7, 5, SimTime(1.5)));
+        REQUIRE(table.isKnown(8, 5, SimTime(1.5)));
+        REQUIRE(table.size(SimTime(1.5)) == 1);
+        // a forgotten sender starts again from any sequence number
+        REQUIRE(table.update(7, 0, SimTime(1.5)));
+    }
+
+    SECTION("keeps all senders while they are alive")
+    {
+        REQUIRE(receiveFromAllSenders(table, 0, SimTime(0)) == SENDERS);
+        REQUIRE(table.size(SimTime(0)) == SENDERS);
+        REQUIRE(receiveFromAllSenders(table, 0, SimTime(0.5)) == 2 * SENDERS);
+        REQUIRE(receiveFromAllSenders(table, 1, SimTime(0.5)) == SENDERS);
+    }
+
+    SECTION("bounds the memory with sender churn")
+    {
+        // 100 senders at a time, each one replaced by a new one every second
+        for (int second = 0; second < 100; second++) {
+            for (int sender = second * 100; sender < (second + 1) * 100; sender++) {
+                REQUIRE(table.update(sender, 0, SimTime(second)));
+            }
+        }
+        REQUIRE(table.size(SimTime(99)) == 200);
+        REQUIRE(table.capacity() <= 1024);
+        // senders are still found after the table has been resized
+        REQUIRE(table.isKnown(9999, 0, SimTime(99)));
+        REQUIRE(table.isKnown(9800, 0, SimTime(99)));
+        REQUIRE_FALSE(table.isKnown(9700, 0, SimTime(99)));
+    }
+}
+
+TEST_CASE("SequenceNumberTable performance", "[utilities][!benchmark]")
+{
+    DummySimulation ds(new cNullEnvir(0, nullptr, nullptr));
+    SequenceNumberTable table;
+    std::map<int, int> map;
+    int sequenceNumber = 0;
+    int duplicates = 0;
+
+    // fill the tables, so that the benchmarks measure lookups and updates only
+    receiveFromAllSenders(table, sequenceNumber, SimTime(0));
+    receiveFromAllSenders(map, sequenceNumber);
+
+    BENCHMARK("10000 senders, twice each, std::map")
+    {
+        sequenceNumber++;
+        duplicates = receiveFromAllSenders(map, sequenceNumber);
+    }
+    REQUIRE(duplicates == SENDERS);
+
+    sequenceNumber = 0;
+    BENCHMARK("10000 senders, twice each, SequenceNumberTable")
+    {
+        sequenceNumber++;
+        duplicates = receiveFromAllSenders(table, sequenceNumber, SimTime(0));
+    }
+    REQUIRE(duplicates == SENDERS);
+    REQUIRE(table.size(SimTime(0)) == SENDERS);
+}
@@ -33,6 +33,7 @@ void VlcRepropagationProtocol::initialize(int stage)
     BaseProtocol::initialize(stage);
 
     if (stage == 0) {
+        seqNumbers.setMaxAge(SimTime(par("knownBeaconsMaxAge").doubleValue()));
         // random start time
         SimTime beginTime = SimTime(uniform(0.001, beaconingInterval));
         if (beaconingInterval > 0) scheduleAt(simTime() + beaconingInterval + beginTime, sendBeacon);
@@ -63,21 +64,7 @@ void VlcRepropagationProtocol::handleSelfMsg(cMessage* msg)
 
 bool VlcRepropagationProtocol::updateAndCheckRepropagation(PlatooningBeacon* pkt)
 {
-    int senderId = pkt->getVehicleId();
-    auto seqNumber = seqNumbers.find(senderId);
-    if (seqNumber == seqNumbers.end()) {
-        seqNumbers[senderId] = pkt->getSequenceNumber();
-        return true;
-    }
-    else {
-        if (pkt->getSequenceNumber() > seqNumber->second) {
-            seqNumbers[senderId] = pkt->getSequenceNumber();
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
+    return seqNumbers.update(pkt->getVehicleId(), pkt->getSequenceNumber(), simTime());
 }
 
 void VlcRepropagationProtocol::messageReceived(PlatooningBeacon* pkt, veins::BaseFrame1609_4* frame)
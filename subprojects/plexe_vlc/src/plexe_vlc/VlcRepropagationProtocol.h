@@ -21,13 +21,14 @@
 #pragma once
 
 #include "plexe/protocols/BaseProtocol.h"
+#include "plexe/utilities/SequenceNumberTable.h"
 
 namespace plexe {
 
 class VlcRepropagationProtocol : public BaseProtocol {
 private:
-    typedef std::map<int, int> SeqNumbers;
-    SeqNumbers seqNumbers;
+    // last sequence number repropagated for each vehicle
+    SequenceNumberTable seqNumbers;
 
     /**
      * Updates the list of known packets and tells whether the packet needs to be repropagated